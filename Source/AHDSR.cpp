@@ -2,32 +2,114 @@
 
 void AHDSR::setSampleRate(double sr) {
 	this->sampleRate = (sr > 0.0) ? sr : 44100.0f;
+	sustainSmoothed.reset(sampleRate, 0.02);
+	setStageLength(getStageLength(state));
 }
 
 void AHDSR::reset() {
 	state = State::Idle;
 	level = 0.0f;
-	t = 0.0f;
-	releaseStartLevel = 0.0f;
+	stageSample = 0;
+	stageLength = 0;
+	segmentStart = 0.0f;
+	segmentOffset = 0;
+	fastReleaseTime = 0.0f;
 }
 
 void AHDSR::setParameters(const Params& p) {
+	const bool curveChanged = p.curve != params.curve;
+
 	params.attack = std::max(0.0f, p.attack);
 	params.hold = std::max(0.0f, p.hold);
 	params.decay = std::max(0.0f, p.decay);
 	params.sustain = juce::jlimit(0.0f, 1.0f, p.sustain);
 	params.release = std::max(0.0f, p.release);
+	params.curve = p.curve;
+	sustainSmoothed.setTargetValue(params.sustain);
+
+	const int newLength = getStageLength(state);
+	if (newLength != stageLength)
+		setStageLength(newLength);
+	else if (curveChanged)
+		anchorSegment();
+}
+
+float AHDSR::getStageDuration(State s) const {
+	switch (s) {
+		case State::Attack:  return params.attack;
+		case State::Hold:    return params.hold;
+		case State::Decay:   return params.decay;
+		case State::Release: return fastReleaseTime > 0.0f ? fastReleaseTime : params.release;
+		default:             return 0.0f;
+	}
+}
+
+int AHDSR::getStageLength(State s) const {
+	return juce::roundToInt(getStageDuration(s) * sampleRate);
+}
+
+void AHDSR::setStageLength(int newLength) {
+	if (newLength == stageLength)
+		return;
+
+	// Keep the same fraction of the running stage and continue from the current level, so a
+	// new duration bends the rest of the segment instead of jumping.
+	if (stageLength > 0)
+		stageSample = static_cast<int>(static_cast<juce::int64>(stageSample) * newLength / stageLength);
+	stageLength = newLength;
+	anchorSegment();
+}
+
+void AHDSR::anchorSegment() {
+	segmentStart = level;
+	segmentOffset = stageSample;
+
+	// One-pole coefficient that covers the remaining samples: the distance to the overshot aim
+	// shrinks to overshoot / (1 + overshoot) of its start, which is exactly the target.
+	const int remaining = stageLength - segmentOffset;
+	if (params.curve == Curve::Exponential && remaining > 0) {
+		const double overshoot = (state == State::Attack) ? attackOvershoot : decayOvershoot;
+		curveCoefficient = std::pow(overshoot / (1.0 + overshoot), 1.0 / remaining);
+	} else {
+		curveCoefficient = 0.0;
+	}
+}
+
+void AHDSR::enterStage(State s) {
+	state = s;
+	stageSample = 0;
+	stageLength = getStageLength(s);
+	anchorSegment();
+
+	if (stageLength > 0)
+		return;
+
+	// Zero-length stages are passed straight through.
+	switch (s) {
+		case State::Attack:  level = 1.0f; enterStage(State::Hold); break;
+		case State::Hold:    enterStage(State::Decay); break;
+		case State::Decay:   level = sustainSmoothed.getCurrentValue(); enterStage(State::Sustain); break;
+		case State::Release: level = 0.0f; state = State::Idle; break;
+		default: break;
+	}
 }
 
 void AHDSR::noteOn() {
-	state = State::Attack;
-	t = 0.0f;
+	sustainSmoothed.setCurrentAndTargetValue(params.sustain);
+	fastReleaseTime = 0.0f;
+	enterStage(State::Attack);
 }
 
 void AHDSR::noteOff() {
-	releaseStartLevel = level;
-	state = State::Release;
-	t = 0.0f;
+	if (state != State::Idle)
+		enterStage(State::Release);
+}
+
+void AHDSR::fastRelease(float seconds) {
+	if (state == State::Idle)
+		return;
+	fastReleaseTime = std::max(seconds, 1.0e-6f);
+	enterStage(State::Release);
 }
 
 bool AHDSR::isActive() {
@@ -35,76 +117,95 @@ bool AHDSR::isActive() {
 }
 
 float AHDSR::getNextSample() {
-	const float dt = 1.0 / static_cast<float>(sampleRate);
-
-	switch (state) {
-		case State::Idle: return 0.0f;
-		case State::Attack: {
-			if (params.attack <= 0.0f) {
-				level = 1.0f;
-				state = State::Hold;
-				t = 0.0f;
-				return level;
-			}
+	float sample;
+	renderBlock(&sample, 1);
+	return sample;
+}
 
-			t += dt;
-			level = juce::jlimit(0.0f, 1.0f, t / params.attack);
-			if (level >= 1.0f) {
-				state = State::Hold;
-				t = 0.0f;
-			}
-			return level;
+void AHDSR::renderBlock(float* dest, int numSamples) {
+	// Stage boundaries are resolved here; the segment loops below run without branching on state.
+	while (numSamples > 0) {
+		if (state == State::Idle) {
+			juce::FloatVectorOperations::clear(dest, numSamples);
+			return;
 		}
-		case State::Hold: {
-			if (params.hold <= 0.0f) {
-				state = State::Decay;
-				t = 0.0f;
-				return level;
-			}
-
-			t += dt;
-			if (t >= params.hold) {
-				state = State::Decay;
-				t = 0.0f;
-			}
-			return level;
+		if (state == State::Sustain) {
+			renderSustain(dest, numSamples);
+			return;
 		}
-		case State::Decay: {
-			if (params.decay <= 0.0f) {
-				level = params.sustain;
-				state = State::Sustain;
-				return level;
-			}
 
-			t += dt;
-			const float a = (params.decay > 0.0f) ? (t / params.decay) : 1.0f;
-			level = juce::jlimit(0.0f, 1.0f, 1.0f - (a * (1.0f - params.sustain)));
-			if (t >= params.decay) {
-				state = State::Sustain;
-				level = params.sustain;
+		const int n = juce::jlimit(0, numSamples, stageLength - stageSample);
+		renderSegment(dest, n);
+		dest += n;
+		numSamples -= n;
+	}
+}
+
+void AHDSR::renderSegment(float* dest, int numSamples) {
+	float target = 0.0f;
+	switch (state) {
+		case State::Attack: target = 1.0f; break;
+		case State::Hold:   target = level; break;
+		case State::Decay:
+			// A moving sustain target restarts the segment from here so the output stays continuous.
+			if (sustainSmoothed.isSmoothing())
+				anchorSegment();
+			target = sustainSmoothed.skip(numSamples);
+			break;
+		default:            target = 0.0f; break;
+	}
+
+	if (numSamples > 0) {
+		if (curveCoefficient > 0.0 && state != State::Hold) {
+			// y += (aim - y) * (1 - c), folded into one multiply-add per sample.
+			const float overshoot = (state == State::Attack) ? attackOvershoot : decayOvershoot;
+			const double aim = target + overshoot * (target - segmentStart);
+			const double base = aim * (1.0 - curveCoefficient);
+			double y = level;
+			for (int i = 0; i < numSamples; ++i) {
+				y = y * curveCoefficient + base;
+				dest[i] = static_cast<float>(y);
 			}
-			return level;
-		}
-		case State::Sustain: {
-			return params.sustain;
+		} else {
+			// Computed from the segment start rather than accumulated, so it lands exactly on target.
+			const float slope = (target - segmentStart) / static_cast<float>(stageLength - segmentOffset);
+			const int first = stageSample - segmentOffset + 1;
+			for (int i = 0; i < numSamples; ++i)
+				dest[i] = segmentStart + slope * static_cast<float>(first + i);
 		}
-		case State::Release: {
-			if (params.release <= 0.0f) {
-				level = 0.0f;
-				state = State::Idle;
-				return level;
-			}
 
-			t += dt;
-			const double progress = juce::jlimit(0.0f, 1.0f, t / params.release);
-			level = static_cast<float>(releaseStartLevel * (1.0 - progress));
+		level = dest[numSamples - 1];
+		stageSample += numSamples;
+	}
 
-			if (progress >= 1.0 || level <= 1.0e-5f) {
-				level = 0.0f;
-				state = State::Idle;
-			}
-			return level;
+	if (stageSample >= stageLength) {
+		level = target;
+		if (numSamples > 0)
+			dest[numSamples - 1] = target;
+
+		switch (state) {
+			case State::Attack:  enterStage(State::Hold); break;
+			case State::Hold:    enterStage(State::Decay); break;
+			case State::Decay:   enterStage(State::Sustain); break;
+			default:             level = 0.0f; state = State::Idle; break;
 		}
-		default: { jassertfalse; return 0.0f; }
+	} else if (state == State::Release && level < silenceThreshold) {
+		level = 0.0f;
+		state = State::Idle;
 	}
+}
+
+void AHDSR::renderSustain(float* dest, int numSamples) {
+	if (sustainSmoothed.isSmoothing()) {
+		for (int i = 0; i < numSamples; ++i)
+			dest[i] = sustainSmoothed.getNextValue();
+		level = dest[numSamples - 1];
+		return;
+	}
+
+	// A silent sustain still holds the note: only the release ends it.
+	level = sustainSmoothed.getTargetValue();
+	if (level < silenceThreshold)
+		level = 0.0f;
+	juce::FloatVectorOperations::fill(dest, level, numSamples);
 }
\ No newline at end of file
@@ -3,12 +3,19 @@
 
 struct AHDSR {
 public:
+	enum class Curve { Linear, Exponential };
+	enum class State : juce::uint8 { Idle, Attack, Hold, Decay, Sustain, Release };
+
+	// Below this (-80 dB) the envelope counts as finished and the voice is freed.
+	static constexpr float silenceThreshold = 1.0e-4f;
+
 	struct Params {
 		float attack = 0.01f;
 		float hold = 0.0f;
 		float decay = 1.0f;
 		float sustain = 0.5f;
 		float release = 0.01f;
+		Curve curve = Curve::Linear;
 	};
 
 	void setSampleRate(double sr);
@@ -16,16 +23,43 @@ public:
 	void setParameters(const Params& p);
 	void noteOn();
 	void noteOff();
+	// Releases to silence over `seconds` whatever the release setting, e.g. to fade out a
+	// stolen voice. Holds until the next noteOn or reset.
+	void fastRelease(float seconds);
 	bool isActive();
 	float getNextSample();
+	void renderBlock(float* dest, int numSamples);
+	State getState() const { return state; }
+	float getLevel() const { return level; }
 
 private:
-	enum class State {Idle, Attack, Hold, Decay, Sustain, Release};
 	State state = State::Idle;
 
+	// Exponential segments aim past their target by this fraction of the segment's span, which
+	// sets how curved they are. The attack bows outwards like an RC charge; decay and release
+	// fall off fast and settle in over the tail.
+	static constexpr float attackOvershoot = 0.3f;
+	static constexpr float decayOvershoot = 1.0e-4f;
+
+	float getStageDuration(State s) const;
+	int getStageLength(State s) const;
+	void setStageLength(int newLength);
+	void anchorSegment();
+	void enterStage(State s);
+	void renderSegment(float* dest, int numSamples);
+	void renderSustain(float* dest, int numSamples);
+
 	Params params;
+	juce::SmoothedValue<float> sustainSmoothed{ 0.5f };
 	double sampleRate{ 44100.0 };
-	float  t{ 0.0f };
 	float  level{ 0.0f };
-	float  releaseStartLevel{ 0.0f };
+
+	// Position within the running stage in whole samples, so long stages don't drift. A segment
+	// runs from segmentStart at segmentOffset to the stage target at stageLength.
+	int    stageSample{ 0 };
+	int    stageLength{ 0 };
+	int    segmentOffset{ 0 };
+	float  segmentStart{ 0.0f };
+	double curveCoefficient{ 0.0 };
+	float  fastReleaseTime{ 0.0f }; // replaces params.release when above zero
 };
\ No newline at end of file
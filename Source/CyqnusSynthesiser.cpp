@@ -0,0 +1,278 @@
+#include "CyqnusSynthesiser.h"
+
+CyqnusSynthesiser::CyqnusSynthesiser() {
+	static_assert(maxVoices <= VoiceAllocator::maxVoices, "every voice needs an allocator entry");
+	activeVoices.reserve(maxVoices);
+}
+
+void CyqnusSynthesiser::prepare(double sampleRate, int samplesPerBlock) {
+	setCurrentPlaybackSampleRate(sampleRate);
+	allocator.reset(voices.size());
+	voiceBus.setSize(2, juce::jmax(1, samplesPerBlock));
+
+	// Workers sized for the old bus would be too small; they come back with prepareRenderPool.
+	releaseRenderPool();
+}
+
+void CyqnusSynthesiser::prepareRenderPool() {
+	if (renderPoolReady.load(std::memory_order_acquire) || voiceBus.getNumSamples() == 0)
+		return;
+
+	const int numWorkers = juce::jlimit(0, 15, juce::SystemStats::getNumCpus() - 1);
+	renderPool.prepare(numWorkers, voiceBus.getNumChannels(), voiceBus.getNumSamples());
+	renderPoolReady.store(true, std::memory_order_release);
+}
+
+void CyqnusSynthesiser::releaseRenderPool() {
+	renderPoolReady.store(false, std::memory_order_release);
+	renderPool.release();
+}
+
+void CyqnusSynthesiser::setPolyphony(int numVoices) {
+	polyphony = juce::jlimit(1, maxVoices, numVoices);
+}
+
+void CyqnusSynthesiser::setStealPolicy(StealPolicy policy) {
+	stealPolicy = policy;
+}
+
+void CyqnusSynthesiser::setParallelRendering(bool shouldRenderInParallel) {
+	parallel = shouldRenderInParallel;
+}
+
+void CyqnusSynthesiser::setMpeMode(bool shouldUseMpe) {
+	mpe = shouldUseMpe;
+}
+
+void CyqnusSynthesiser::setVoiceBank(VoiceBank* bank) {
+	voiceBank = bank;
+}
+
+bool CyqnusSynthesiser::isSilent() const {
+	for (auto list : { VoiceAllocator::Sounding, VoiceAllocator::Fading })
+		for (int v = allocator.getFront(list); v >= 0; v = allocator.getNext(v))
+			if (voices.getUnchecked(v)->isVoiceActive())
+				return false;
+	return true;
+}
+
+void CyqnusSynthesiser::noteOn(int midiChannel, int midiNoteNumber, float velocity) {
+	const juce::ScopedLock sl(lock);
+
+	if (mpe && midiChannel > SynthVoice::mpeMasterChannel && midiChannel <= 16)
+		channelStates[static_cast<size_t>(midiChannel)].pressure = velocity;
+
+	for (auto* sound : sounds) {
+		if (!sound->appliesToNote(midiNoteNumber) || !sound->appliesToChannel(midiChannel))
+			continue;
+
+		// A note that is still ringing (e.g. held by the sustain pedal) is released first, or
+		// with the same-note policy faded out quickly so repeated notes don't pile up.
+		for (int v = allocator.getFront(VoiceAllocator::Sounding); v >= 0;) {
+			auto* voice = voices.getUnchecked(v);
+			const int next = allocator.getNext(v);
+
+			if (voice->getCurrentlyPlayingNote() == midiNoteNumber && voice->isPlayingChannel(midiChannel)) {
+				if (stealPolicy == StealPolicy::SameNote)
+					fadeOut(v);
+				else
+					stopVoice(voice, 1.0f, true);
+			}
+			v = next;
+		}
+
+		startVoice(findFreeVoice(sound, midiChannel, midiNoteNumber, isNoteStealingEnabled()),
+			sound, midiChannel, midiNoteNumber, velocity);
+	}
+}
+
+void CyqnusSynthesiser::noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff) {
+	const juce::ScopedLock sl(lock);
+
+	for (int v = allocator.getFront(VoiceAllocator::Sounding); v >= 0; v = allocator.getNext(v)) {
+		auto* voice = voices.getUnchecked(v);
+		if (voice->getCurrentlyPlayingNote() != midiNoteNumber || !voice->isPlayingChannel(midiChannel))
+			continue;
+
+		auto sound = voice->getCurrentlyPlayingSound();
+		if (sound != nullptr && sound->appliesToNote(midiNoteNumber) && sound->appliesToChannel(midiChannel)) {
+			voice->setKeyDown(false);
+			if (!(voice->isSustainPedalDown() || voice->isSostenutoPedalDown()))
+				stopVoice(voice, velocity, allowTailOff);
+		}
+	}
+}
+
+void CyqnusSynthesiser::handlePitchWheel(int midiChannel, int wheelValue) {
+	juce::Synthesiser::handlePitchWheel(midiChannel, wheelValue);
+	if (midiChannel >= 1 && midiChannel <= 16)
+		channelStates[static_cast<size_t>(midiChannel)].pitchWheel = SynthVoice::toPitchWheel(wheelValue);
+}
+
+void CyqnusSynthesiser::handleController(int midiChannel, int controllerNumber, int controllerValue) {
+	juce::Synthesiser::handleController(midiChannel, controllerNumber, controllerValue);
+	if (midiChannel < 1 || midiChannel > 16)
+		return;
+
+	auto& state = channelStates[static_cast<size_t>(midiChannel)];
+	if (controllerNumber == SynthVoice::modWheelController)
+		state.modWheel = controllerValue / 127.0f;
+	else if (controllerNumber == SynthVoice::slideController)
+		state.slide = controllerValue / 127.0f;
+}
+
+void CyqnusSynthesiser::handleChannelPressure(int midiChannel, int channelPressureValue) {
+	juce::Synthesiser::handleChannelPressure(midiChannel, channelPressureValue);
+	if (midiChannel >= 1 && midiChannel <= 16)
+		channelStates[static_cast<size_t>(midiChannel)].pressure = channelPressureValue / 127.0f;
+}
+
+void CyqnusSynthesiser::handleSustainPedal(int midiChannel, bool isDown) {
+	if (mpe && midiChannel == SynthVoice::mpeMasterChannel) {
+		for (int channel = 1; channel <= 16; ++channel)
+			juce::Synthesiser::handleSustainPedal(channel, isDown);
+		return;
+	}
+	juce::Synthesiser::handleSustainPedal(midiChannel, isDown);
+}
+
+void CyqnusSynthesiser::handleSostenutoPedal(int midiChannel, bool isDown) {
+	if (mpe && midiChannel == SynthVoice::mpeMasterChannel) {
+		for (int channel = 1; channel <= 16; ++channel)
+			juce::Synthesiser::handleSostenutoPedal(channel, isDown);
+		return;
+	}
+	juce::Synthesiser::handleSostenutoPedal(midiChannel, isDown);
+}
+
+juce::SynthesiserVoice* CyqnusSynthesiser::findFreeVoice(juce::SynthesiserSound*, int, int,
+	bool stealIfNoneAvailable) const {
+	// Every voice plays the one SynthSound, so any free voice will do.
+	const int limit = juce::jmin(polyphony, voices.size());
+	if (allocator.getSize(VoiceAllocator::Sounding) >= limit || allocator.getSize(VoiceAllocator::Free) == 0)
+		releaseFinishedVoices();
+
+	if (allocator.getSize(VoiceAllocator::Sounding) >= limit) {
+		if (!stealIfNoneAvailable)
+			return nullptr;
+
+		fadeOut(findVoiceToSteal());
+		++numStolenVoices;
+	}
+
+	int index = allocator.takeFree();
+	if (index < 0) {
+		// Every voice is busy: cut the one furthest into its fade (startVoice stops it).
+		index = allocator.getFront(VoiceAllocator::Fading);
+		if (index < 0)
+			return nullptr;
+		allocator.moveTo(index, VoiceAllocator::Sounding);
+	}
+	return voices.getUnchecked(index);
+}
+
+int CyqnusSynthesiser::findVoiceToSteal() const {
+	// The sounding list is in note-on order, so the oldest voice is at its front.
+	const int oldest = allocator.getFront(VoiceAllocator::Sounding);
+	jassert(oldest >= 0);
+
+	switch (stealPolicy) {
+		case StealPolicy::Oldest:
+			return oldest;
+
+		case StealPolicy::Quietest: {
+			int quietest = oldest;
+			float quietestLevel = getSynthVoice(oldest)->getEnvelopeLevel();
+			for (int v = allocator.getNext(oldest); v >= 0; v = allocator.getNext(v)) {
+				const float level = getSynthVoice(v)->getEnvelopeLevel();
+				if (level < quietestLevel) {
+					quietest = v;
+					quietestLevel = level;
+				}
+			}
+			return quietest;
+		}
+
+		case StealPolicy::ReleasedFirst:
+		case StealPolicy::SameNote:
+		default:
+			for (int v = oldest; v >= 0; v = allocator.getNext(v))
+				if (voices.getUnchecked(v)->isPlayingButReleased())
+					return v;
+			return oldest;
+	}
+}
+
+void CyqnusSynthesiser::fadeOut(int index) const {
+	allocator.moveTo(index, VoiceAllocator::Fading);
+	getSynthVoice(index)->fadeOut(stealFadeSeconds);
+}
+
+void CyqnusSynthesiser::releaseFinishedVoices() const {
+	for (auto list : { VoiceAllocator::Sounding, VoiceAllocator::Fading }) {
+		for (int v = allocator.getFront(list); v >= 0;) {
+			const int next = allocator.getNext(v);
+			if (!voices.getUnchecked(v)->isVoiceActive())
+				allocator.moveTo(v, VoiceAllocator::Free);
+			v = next;
+		}
+	}
+}
+
+void CyqnusSynthesiser::renderVoices(juce::AudioBuffer<float>& output, int startSample, int numSamples) {
+	jassert(voiceBus.getNumSamples() > 0); // prepare() first
+
+	// Hosts may exceed the block size they announced, so the bus is filled in pieces.
+	for (int offset = 0; offset < numSamples;) {
+		const int n = juce::jmin(numSamples - offset, voiceBus.getNumSamples());
+		renderVoiceBus(n);
+		mixDown(output, startSample + offset, n);
+		offset += n;
+	}
+
+	// The last piece of the buffer ends the host block (or its oversampled copy): each voice
+	// that rendered in it records its load once, however often it was split.
+	if (startSample + numSamples == output.getNumSamples())
+		for (int i = 0; i < voices.size(); ++i)
+			getSynthVoice(i)->recordLoad();
+}
+
+void CyqnusSynthesiser::renderVoiceBus(int numSamples) {
+	voiceBus.clear(0, numSamples);
+
+	// First, so the front-end voices below see which bank notes finished in this block.
+	if (voiceBank != nullptr)
+		voiceBank->render(voiceBus, 0, numSamples);
+
+	// Voices that finished in the last block go back on the free list here.
+	releaseFinishedVoices();
+
+	activeVoices.clear();
+	for (auto list : { VoiceAllocator::Sounding, VoiceAllocator::Fading })
+		for (int v = allocator.getFront(list); v >= 0; v = allocator.getNext(v))
+			activeVoices.push_back(voices.getUnchecked(v));
+
+	const int numActive = static_cast<int>(activeVoices.size());
+	if (parallel && numActive >= minVoicesForParallel && renderPoolReady.load(std::memory_order_acquire)
+		&& renderPool.canRender(numSamples)) {
+		renderPool.render(activeVoices.data(), numActive, voiceBus, 0, numSamples);
+		return;
+	}
+
+	for (auto* voice : activeVoices)
+		voice->renderNextBlock(voiceBus, 0, numSamples);
+}
+
+void CyqnusSynthesiser::mixDown(juce::AudioBuffer<float>& output, int startSample, int numSamples) const {
+	const auto* busLeft = voiceBus.getReadPointer(0);
+	const auto* busRight = voiceBus.getReadPointer(1);
+
+	if (output.getNumChannels() > 1) {
+		juce::FloatVectorOperations::add(output.getWritePointer(0, startSample), busLeft, numSamples);
+		juce::FloatVectorOperations::add(output.getWritePointer(1, startSample), busRight, numSamples);
+	} else if (output.getNumChannels() == 1) {
+		auto* mono = output.getWritePointer(0, startSample);
+		juce::FloatVectorOperations::addWithMultiply(mono, busLeft, 0.5f, numSamples);
+		juce::FloatVectorOperations::addWithMultiply(mono, busRight, 0.5f, numSamples);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+#include <JuceHeader.h>
+#include "VoiceRenderPool.h"
+#include "VoiceBank.h"
+#include "VoiceAllocator.h"
+#include "SynthVoice.h"
+#include "ModMatrix.h"
+
+// juce::Synthesiser with a runtime polyphony limit, its own voice allocation and an optional
+// parallel render path. All maxVoices voices (SynthVoices) are created up front; at most
+// `polyphony` of them play notes, the rest are spare. A stolen note is faded out on its own
+// voice over stealFadeSeconds while the new note starts on a spare one, so stealing doesn't
+// click. Only with every voice busy is a note cut outright.
+//
+// Voices never write to the output buffer themselves: they all add into a stereo voice bus
+// (the render pool's lanes when parallel), which is mixed down into the output in one pass.
+// A mono output is folded down there rather than by every voice.
+class CyqnusSynthesiser : public juce::Synthesiser {
+public:
+	static constexpr int maxVoices = 256;
+	static constexpr float stealFadeSeconds = 0.005f;
+	using StealPolicy = VoiceAllocator::StealPolicy;
+
+	CyqnusSynthesiser();
+
+	void prepare(double sampleRate, int samplesPerBlock);
+
+	void setPolyphony(int numVoices);
+	void setStealPolicy(StealPolicy policy);
+	void setParallelRendering(bool shouldRenderInParallel);
+	// Message thread only. The render pool's workers are started the first time parallel
+	// rendering is wanted rather than in prepare, and stopped again by releaseRenderPool,
+	// which must not run while the audio thread renders (e.g. from releaseResources).
+	void prepareRenderPool();
+	void releaseRenderPool();
+	// MPE lower zone: pedals on the master channel hold every member channel, and each note
+	// starts with its velocity as pressure until its channel sends some.
+	void setMpeMode(bool shouldUseMpe);
+
+	// Voices that hand their notes to the bank are rendered by it in one pass per block.
+	void setVoiceBank(VoiceBank* bank);
+
+	// True when no voice is sounding, i.e. rendering would only add silence.
+	bool isSilent() const;
+
+	// Notes that had to take over a sounding voice since the synth was created.
+	int getNumStolenVoices() const { return numStolenVoices; }
+
+	// Same as juce::Synthesiser's, but they only visit the voices that are playing.
+	void noteOn(int midiChannel, int midiNoteNumber, float velocity) override;
+	void noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff) override;
+
+	// These also keep channelStates current for the matrix sources of notes yet to start.
+	void handlePitchWheel(int midiChannel, int wheelValue) override;
+	void handleController(int midiChannel, int controllerNumber, int controllerValue) override;
+	void handleChannelPressure(int midiChannel, int channelPressureValue) override;
+	void handleSustainPedal(int midiChannel, bool isDown) override;
+	void handleSostenutoPedal(int midiChannel, bool isDown) override;
+
+	// Indexed by MIDI channel, 1 to 16.
+	const MidiChannelState* getChannelStates() const { return channelStates.data(); }
+
+protected:
+	juce::SynthesiserVoice* findFreeVoice(juce::SynthesiserSound* sound, int midiChannel,
+		int midiNoteNumber, bool stealIfNoneAvailable) const override;
+	void renderVoices(juce::AudioBuffer<float>& output, int startSample, int numSamples) override;
+
+private:
+	// Below this many sounding voices the hand-off costs more than it saves.
+	static constexpr int minVoicesForParallel = 8;
+
+	// Every voice is a SynthVoice (see CyqnusAudioProcessor's constructor).
+	SynthVoice* getSynthVoice(int index) const { return static_cast<SynthVoice*>(voices.getUnchecked(index)); }
+
+	void renderVoiceBus(int numSamples);
+	void mixDown(juce::AudioBuffer<float>& output, int startSample, int numSamples) const;
+
+	int findVoiceToSteal() const;
+	void fadeOut(int index) const;
+	void releaseFinishedVoices() const;
+
+	int polyphony = 8;
+	StealPolicy stealPolicy = StealPolicy::ReleasedFirst;
+	bool parallel = false;
+	bool mpe = false;
+	VoiceBank* voiceBank = nullptr;
+
+	// Updated from the const findFreeVoice as well; audio thread only.
+	mutable VoiceAllocator allocator;
+	mutable int numStolenVoices = 0;
+
+	std::array<MidiChannelState, 17> channelStates{};
+
+	std::vector<juce::SynthesiserVoice*> activeVoices;
+	juce::AudioBuffer<float> voiceBus;
+	VoiceRenderPool renderPool;
+	std::atomic<bool> renderPoolReady{ false };
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+#include <JuceHeader.h>
+#include "AHDSR.h"
+
+// State of the engine after one processBlock, as published to the editor.
+struct TelemetryFrame {
+	static constexpr int maxVoices = 256;
+
+	std::array<float, 2> peak{};
+	std::array<float, 2> rms{};
+	int    numActiveVoices = 0;
+	int    polyphony = 0;
+	int    numStolenVoices = 0;  // running total, the editor shows the difference
+	double processSeconds = 0.0; // wall time spent in processBlock
+	double blockSeconds = 0.0;   // audio time the block covers
+	std::array<AHDSR::State, maxVoices> voiceState{}; // amp envelope stage, by voice index
+};
+
+// Single-producer/single-consumer channel from the audio thread to the editor. push()
+// never blocks or allocates; while the editor is behind, frames are merged on the audio
+// side and the result is published as soon as there is room, so no peak is lost.
+class EngineTelemetry {
+public:
+	static constexpr int capacity = 32;
+
+	// Returns false when the frame was held back for merging.
+	bool push(const TelemetryFrame& frame) {
+		const auto scope = fifo.write(1);
+		if (scope.blockSize1 == 0) {
+			if (hasPending)
+				accumulate(pending, frame);
+			else
+				pending = frame;
+			hasPending = true;
+			numMerged.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		auto& slot = frames[static_cast<size_t>(scope.startIndex1)];
+		if (hasPending) {
+			accumulate(pending, frame);
+			slot = pending;
+			hasPending = false;
+		} else {
+			slot = frame;
+		}
+		return true;
+	}
+
+	bool pop(TelemetryFrame& frame) {
+		const auto scope = fifo.read(1);
+		if (scope.blockSize1 == 0)
+			return false;
+		frame = frames[static_cast<size_t>(scope.startIndex1)];
+		return true;
+	}
+
+	// Frames that reached the editor merged with a later one.
+	int getNumMerged() const { return numMerged.load(std::memory_order_relaxed); }
+
+private:
+	// Levels and load keep their maximum; the rest, including the running steal count,
+	// comes from the later frame.
+	static void accumulate(TelemetryFrame& earlier, const TelemetryFrame& later) {
+		for (size_t ch = 0; ch < 2; ++ch) {
+			earlier.peak[ch] = juce::jmax(earlier.peak[ch], later.peak[ch]);
+			earlier.rms[ch] = juce::jmax(earlier.rms[ch], later.rms[ch]);
+		}
+
+		if (later.processSeconds * earlier.blockSeconds >= earlier.processSeconds * later.blockSeconds) {
+			earlier.processSeconds = later.processSeconds;
+			earlier.blockSeconds = later.blockSeconds;
+		}
+
+		earlier.numActiveVoices = later.numActiveVoices;
+		earlier.polyphony = later.polyphony;
+		earlier.numStolenVoices = later.numStolenVoices;
+		earlier.voiceState = later.voiceState;
+	}
+
+	juce::AbstractFifo fifo{ capacity };
+	std::array<TelemetryFrame, capacity> frames;
+	std::atomic<int> numMerged{ 0 };
+
+	// Audio thread only.
+	TelemetryFrame pending;
+	bool hasPending = false;
+};
\ No newline at end of file
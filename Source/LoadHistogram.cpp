@@ -0,0 +1,88 @@
+#include "LoadHistogram.h"
+
+void LoadHistogram::record(double seconds, double budgetSeconds) {
+	if (budgetSeconds <= 0.0)
+		return;
+
+	const double load = seconds / budgetSeconds;
+	const int bin = juce::jlimit(0, numBins - 1, static_cast<int>(load / binWidth));
+	bins[static_cast<size_t>(bin)].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	if (load >= xrunRiskLoad)
+		xrunRiskBlocks.fetch_add(1, std::memory_order_relaxed);
+
+	const auto micros = static_cast<juce::int64>(load * 1.0e6);
+	sumMicros.fetch_add(micros, std::memory_order_relaxed);
+	auto previous = maxMicros.load(std::memory_order_relaxed);
+	while (micros > previous && !maxMicros.compare_exchange_weak(previous, micros, std::memory_order_relaxed)) {}
+}
+
+void LoadHistogram::reset() {
+	// Not atomic as a whole; a block recorded concurrently may be half counted.
+	for (auto& bin : bins)
+		bin.store(0, std::memory_order_relaxed);
+	count.store(0, std::memory_order_relaxed);
+	xrunRiskBlocks.store(0, std::memory_order_relaxed);
+	sumMicros.store(0, std::memory_order_relaxed);
+	maxMicros.store(0, std::memory_order_relaxed);
+}
+
+LoadHistogram::Stats LoadHistogram::getStats() const {
+	std::array<juce::uint32, numBins> counts;
+	juce::int64 total = 0;
+	for (size_t i = 0; i < counts.size(); ++i) {
+		counts[i] = bins[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+
+	Stats stats;
+	stats.count = total;
+	if (total == 0)
+		return stats;
+
+	stats.xrunRiskBlocks = xrunRiskBlocks.load(std::memory_order_relaxed);
+	stats.max = static_cast<double>(maxMicros.load(std::memory_order_relaxed)) * 1.0e-6;
+	stats.mean = static_cast<double>(sumMicros.load(std::memory_order_relaxed)) * 1.0e-6 / static_cast<double>(juce::jmax<juce::int64>(1, count.load(std::memory_order_relaxed)));
+	stats.p50 = getPercentile(counts, total, 0.50, stats.max);
+	stats.p99 = getPercentile(counts, total, 0.99, stats.max);
+	return stats;
+}
+
+double LoadHistogram::getPercentile(const std::array<juce::uint32, numBins>& counts, juce::int64 total, double fraction, double max) const {
+	// Upper edge of the bin the percentile falls in, so the result never understates the load.
+	const auto target = static_cast<juce::int64>(std::ceil(fraction * static_cast<double>(total)));
+	juce::int64 cumulative = 0;
+	for (int i = 0; i < numBins; ++i) {
+		cumulative += counts[static_cast<size_t>(i)];
+		if (cumulative >= target)
+			return juce::jmin(max, (i + 1) * binWidth);
+	}
+	return max;
+}
+
+juce::var LoadHistogram::toVar() const {
+	const auto stats = getStats();
+
+	juce::Array<juce::var> counts;
+	int lastUsed = -1;
+	for (int i = 0; i < numBins; ++i)
+		if (bins[static_cast<size_t>(i)].load(std::memory_order_relaxed) > 0)
+			lastUsed = i;
+	for (int i = 0; i <= lastUsed; ++i)
+		counts.add(static_cast<int>(bins[static_cast<size_t>(i)].load(std::memory_order_relaxed)));
+
+	auto* histogram = new juce::DynamicObject();
+	histogram->setProperty("binWidthPercent", binWidth * 100.0);
+	histogram->setProperty("counts", counts);
+
+	auto* result = new juce::DynamicObject();
+	result->setProperty("blocks", stats.count);
+	result->setProperty("meanPercent", stats.mean * 100.0);
+	result->setProperty("p50Percent", stats.p50 * 100.0);
+	result->setProperty("p99Percent", stats.p99 * 100.0);
+	result->setProperty("maxPercent", stats.max * 100.0);
+	result->setProperty("xrunRiskPercent", xrunRiskLoad * 100.0);
+	result->setProperty("xrunRiskBlocks", stats.xrunRiskBlocks);
+	result->setProperty("histogram", juce::var(histogram));
+	return juce::var(result);
+}
\ No newline at end of file
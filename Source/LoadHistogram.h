@@ -0,0 +1,38 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Distribution of how much of its realtime budget each rendered block used (time taken /
+// audio time covered). Bins are preallocated and record() only does relaxed atomic
+// increments, so it is wait-free and may be called from the audio thread and the voice
+// render workers at once. Readers take a snapshot with getStats().
+class LoadHistogram {
+public:
+	static constexpr int numBins = 400;
+	static constexpr double binWidth = 0.005;   // 0.5 % of the budget; the last bin collects everything above 200 %
+	static constexpr double xrunRiskLoad = 0.8; // blocks above this leave too little headroom for the host
+
+	struct Stats {
+		juce::int64 count = 0;
+		juce::int64 xrunRiskBlocks = 0;
+		double mean = 0.0;
+		double p50 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+	};
+
+	void record(double seconds, double budgetSeconds);
+	void reset();
+
+	Stats getStats() const;
+	// Stats plus the raw bin counts, for writing out as JSON.
+	juce::var toVar() const;
+
+private:
+	double getPercentile(const std::array<juce::uint32, numBins>& counts, juce::int64 total, double fraction, double max) const;
+
+	std::array<std::atomic<juce::uint32>, numBins> bins{};
+	std::atomic<juce::int64> count{ 0 };
+	std::atomic<juce::int64> xrunRiskBlocks{ 0 };
+	std::atomic<juce::int64> sumMicros{ 0 }; // loads in millionths, so they can be summed atomically
+	std::atomic<juce::int64> maxMicros{ 0 };
+};
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Fixed-capacity, sample-ordered list of short MIDI events. Storage is allocated once,
+// so filling and draining it on the audio thread never touches the heap.
+class MidiEventQueue {
+public:
+	struct Event {
+		int samplePosition = 0;
+		int numBytes = 0;
+		juce::uint8 data[3] = {};
+
+		juce::MidiMessage toMessage() const { return juce::MidiMessage(data, numBytes); }
+	};
+
+	static constexpr int capacity = 4096;
+
+	MidiEventQueue() : events(capacity) {}
+
+	void clear() { size = 0; }
+	bool isEmpty() const { return size == 0; }
+	int getNumEvents() const { return size; }
+	int getNumDropped() const { return numDropped; }
+
+	// Keeps the queue ordered by sample position; events at equal positions stay in arrival order.
+	// SysEx and other long messages are ignored, the synth has no use for them.
+	bool add(const juce::uint8* data, int numBytes, int samplePosition) {
+		if (numBytes <= 0 || numBytes > 3)
+			return false;
+
+		if (size == capacity) {
+			++numDropped;
+			jassertfalse;
+			return false;
+		}
+
+		int i = size++;
+		for (; i > 0 && events[i - 1].samplePosition > samplePosition; --i)
+			events[i] = events[i - 1];
+
+		auto& e = events[i];
+		e.samplePosition = samplePosition;
+		e.numBytes = numBytes;
+		std::copy(data, data + numBytes, e.data);
+		return true;
+	}
+
+	void addEvents(const juce::MidiBuffer& buffer) {
+		for (const auto metadata : buffer)
+			add(metadata.data, metadata.numBytes, metadata.samplePosition);
+	}
+
+	const Event* begin() const { return events.data(); }
+	const Event* end() const { return events.data() + size; }
+
+private:
+	std::vector<Event> events;
+	int size = 0;
+	int numDropped = 0;
+};
@@ -0,0 +1,70 @@
+#include "ModMatrix.h"
+
+void ModLfo::reset(juce::uint32 seed) {
+	phase = 0.0f;
+	noise = seed != 0 ? seed : 1;
+	held = NoiseGenerator::toBipolar(NoiseGenerator::step(noise));
+}
+
+float ModLfo::advance(const Params& p, float seconds) {
+	float value = 0.0f;
+	switch (p.shape) {
+	case Sine:
+		value = std::sin(juce::MathConstants<float>::twoPi * phase);
+		break;
+	case Triangle:
+		value = 1.0f - 4.0f * std::abs(phase - 0.5f);
+		break;
+	case Saw:
+		value = 2.0f * phase - 1.0f;
+		break;
+	case Square:
+		value = phase < 0.5f ? 1.0f : -1.0f;
+		break;
+	case SampleAndHold:
+		value = held;
+		break;
+	}
+
+	phase += p.rate * seconds;
+	if (phase >= 1.0f) {
+		phase -= std::floor(phase);
+		held = NoiseGenerator::toBipolar(NoiseGenerator::step(noise));
+	}
+	return value;
+}
+
+void ModMatrix::Routing::clear() {
+	numRoutes = 0;
+	isRouted.fill(false);
+}
+
+void ModMatrix::Routing::add(int source, int destination, float amount) {
+	if (source < 0 || source >= numSources || destination < 0 || destination >= numDestinations
+		|| amount == 0.0f || numRoutes == numSlots)
+		return;
+
+	routes[static_cast<size_t>(numRoutes++)] = { source, destination, amount };
+	isRouted[static_cast<size_t>(destination)] = true;
+}
+
+void ModMatrix::evaluate(const Routing& routing, const SourceValues& sources, DestinationValues& destinations) {
+	destinations.fill(0.0f);
+	for (int i = 0; i < routing.numRoutes; ++i) {
+		const auto& r = routing.routes[static_cast<size_t>(i)];
+		destinations[static_cast<size_t>(r.destination)] += sources[static_cast<size_t>(r.source)] * r.amount;
+	}
+}
+
+juce::StringArray ModMatrix::getSourceNames() {
+	return { "LFO 1", "LFO 2", "Mod Env", "Velocity", "Pitch Wheel", "Mod Wheel", "Aftertouch", "Slide" };
+}
+
+juce::StringArray ModMatrix::getDestinationNames() {
+	juce::StringArray names;
+	for (int osc = 1; osc <= numOscillators; ++osc)
+		for (auto* d : { " Pitch", " Level", " Pulse Width", " Detune" })
+			names.add("Osc " + juce::String(osc) + d);
+	names.add("Voice Pan");
+	return names;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <JuceHeader.h>
+#include "NoiseGenerator.h"
+
+// Per-voice LFO, evaluated once per control period. Sample and hold draws from the voice's
+// own xorshift stream (see NoiseGenerator) so renders repeat exactly.
+class ModLfo {
+public:
+	enum Shape { Sine, Triangle, Saw, Square, SampleAndHold };
+
+	struct Params {
+		Shape shape = Sine;
+		float rate = 2.0f; // Hz
+	};
+
+	// Restarts at phase zero, so every note's modulation starts the same way.
+	void reset(juce::uint32 seed);
+	// Value in [-1, 1] at the current phase, then moves on by `seconds`.
+	float advance(const Params& p, float seconds);
+
+private:
+	float phase = 0.0f;
+	float held = 0.0f;
+	juce::uint32 noise = 1;
+};
+
+// Routes modulation sources to oscillator parameters and the voice's pan. The slots set in
+// the editor are compiled once per block into a Routing, a packed array of the enabled
+// routes, and every voice evaluates it once per control period with one multiply-add per
+// route and no branches, whatever the sources and destinations are.
+struct ModMatrix {
+	enum Source { Lfo1, Lfo2, ModEnv, Velocity, PitchWheel, ModWheel, Aftertouch, Slide, numSources };
+
+	// Per oscillator, in this order: Osc1Pitch, Osc1Level, Osc1PulseWidth, Osc1Detune, Osc2Pitch...
+	// then the voice's own destinations.
+	enum OscDestination { Pitch, Level, PulseWidth, Detune, numOscDestinations };
+	static constexpr int numOscillators = 3;
+	static constexpr int voicePan = numOscillators * numOscDestinations;
+	static constexpr int numDestinations = voicePan + 1;
+	static constexpr int numSlots = 8;
+	static constexpr int numLfos = 2;
+
+	// What a route of amount 1 driven by a full-scale source moves each destination by.
+	static constexpr float pitchRange = 24.0f;     // semitones
+	static constexpr float levelRange = 1.0f;      // gain, added to 1
+	static constexpr float pulseWidthRange = 0.5f; // of a cycle
+	static constexpr float detuneRange = 10.0f;    // Hz
+	static constexpr float panRange = 1.0f;        // hard left or right from centre
+
+	static constexpr int getDestination(int osc, OscDestination d) { return osc * numOscDestinations + d; }
+
+	struct Route {
+		int source = 0;
+		int destination = 0;
+		float amount = 0.0f;
+	};
+
+	struct Routing {
+		std::array<Route, numSlots> routes{};
+		int numRoutes = 0;
+		// Whether any route targets a destination, so untouched ones cost nothing.
+		std::array<bool, numDestinations> isRouted{};
+
+		void clear();
+		// Slots with no source or a zero amount are left out.
+		void add(int source, int destination, float amount);
+	};
+
+	using SourceValues = std::array<float, numSources>;
+	using DestinationValues = std::array<float, numDestinations>;
+
+	static void evaluate(const Routing& routing, const SourceValues& sources, DestinationValues& destinations);
+
+	// Editor and parameter names; slot sources have "Off" in front of these.
+	static juce::StringArray getSourceNames();
+	static juce::StringArray getDestinationNames();
+};
+
+// Latest controller values on one MIDI channel, in the units the matrix sources use.
+// CyqnusSynthesiser keeps one per channel so a note starts from its channel's current
+// wheel, pressure and slide rather than from zero.
+struct MidiChannelState {
+	float pitchWheel = 0.0f; // -1..1
+	float modWheel = 0.0f;   // 0..1
+	float pressure = 0.0f;   // 0..1
+	float slide = 0.0f;      // 0..1, CC 74
+};
\ No newline at end of file
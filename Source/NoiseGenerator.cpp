@@ -0,0 +1,79 @@
+#include "NoiseGenerator.h"
+
+namespace {
+	// splitmix32-style finaliser: every input bit affects every output bit.
+	juce::uint32 mix(juce::uint32 x) {
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+		return x;
+	}
+}
+
+juce::uint32 NoiseGenerator::makeSeed(int voice, int osc, juce::uint32 noteIndex) {
+	const auto seed = mix(mix(static_cast<juce::uint32>(voice) * 0x9e3779b9u + static_cast<juce::uint32>(osc)) ^ noteIndex);
+	return seed != 0 ? seed : 0x9e3779b9u;
+}
+
+NoiseGenerator::NoiseGenerator() {
+	seed(1);
+}
+
+void NoiseGenerator::seed(juce::uint32 s) {
+	// xorshift is stuck at zero, so each lane gets a distinct non-zero state.
+	for (int l = 0; l < laneCount; ++l) {
+		const auto state = mix(s + static_cast<juce::uint32>(l) * 0x9e3779b9u);
+		lanes[static_cast<size_t>(l)] = state != 0 ? state : 0x9e3779b9u;
+	}
+	nextLane = 0;
+	filter = {};
+}
+
+void NoiseGenerator::setColour(Colour c) {
+	if (c != colour)
+		filter = {};
+	colour = c;
+}
+
+float NoiseGenerator::nextWhite() {
+	const float white = toBipolar(step(lanes[static_cast<size_t>(nextLane)]));
+	nextLane = (nextLane + 1) % laneCount;
+	return white;
+}
+
+float NoiseGenerator::getNextSample() {
+	return filter.process(colour, nextWhite());
+}
+
+float NoiseGenerator::nextUnipolar() {
+	return 0.5f * (nextWhite() + 1.0f);
+}
+
+void NoiseGenerator::renderBlock(float* dest, int numSamples) {
+	// Lined up on lane 0, whole rounds of every lane go through the loop that vectorises.
+	int i = 0;
+	for (; i < numSamples && nextLane != 0; ++i)
+		dest[i] = nextWhite();
+	if (i + laneCount <= numSamples) {
+		// The float bit patterns go out as integers and are shifted down from [2, 4) in one
+		// pass afterwards, which keeps the generator loop free of type punning.
+		const int start = i;
+		auto state = lanes; // a local copy the compiler can keep in registers
+		std::array<juce::uint32, laneCount> bits;
+		for (; i + laneCount <= numSamples; i += laneCount) {
+			for (int l = 0; l < laneCount; ++l)
+				bits[static_cast<size_t>(l)] = (step(state[static_cast<size_t>(l)]) >> 9) | 0x40000000u;
+			std::memcpy(dest + i, bits.data(), sizeof(bits));
+		}
+		lanes = state;
+		juce::FloatVectorOperations::add(dest + start, -3.0f, i - start);
+	}
+	for (; i < numSamples; ++i)
+		dest[i] = nextWhite();
+
+	if (colour != White)
+		for (int s = 0; s < numSamples; ++s)
+			dest[s] = filter.process(colour, dest[s]);
+}
\ No newline at end of file
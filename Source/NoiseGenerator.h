@@ -0,0 +1,70 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Noise for the Noise waveform. White noise comes from laneCount interleaved xorshift32
+// streams, so renderBlock's loop has no dependency between neighbouring samples and
+// vectorises; the bits become a float in [-1, 1) by exponent stuffing instead of an
+// int-to-float conversion and divide. Pink and brown noise filter the white stream.
+// Nothing is seeded from the clock: makeSeed gives every voice and oscillator its own
+// stream, so offline renders come out the same every time.
+class NoiseGenerator {
+public:
+	enum Colour { White, Pink, Brown };
+	static constexpr int laneCount = 8;
+
+	// Filter state turning white noise into pink (Paul Kellet's economy filter, -3 dB/octave
+	// within 0.5 dB over most of the audio band) or brown (leaky integrator, -6 dB/octave).
+	// The gains bring both to roughly the loudness of white noise.
+	struct ColourFilter {
+		float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+
+		float process(Colour colour, float white) {
+			if (colour == Pink) {
+				b0 = 0.99765f * b0 + white * 0.0990460f;
+				b1 = 0.96300f * b1 + white * 0.2965164f;
+				b2 = 0.57000f * b2 + white * 1.0526913f;
+				return (b0 + b1 + b2 + white * 0.1848f) * 0.3f;
+			}
+			if (colour == Brown) {
+				b0 = (b0 + 0.02f * white) * (1.0f / 1.02f);
+				return b0 * 8.0f;
+			}
+			return white;
+		}
+	};
+
+	// A well mixed, never zero seed for oscillator `osc` of voice `voice`'s noteIndex-th note.
+	static juce::uint32 makeSeed(int voice, int osc, juce::uint32 noteIndex);
+
+	static juce::uint32 step(juce::uint32& state) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// Top 23 bits as the mantissa of a float in [2, 4), shifted down to [-1, 1).
+	static float toBipolar(juce::uint32 bits) {
+		const juce::uint32 floatBits = (bits >> 9) | 0x40000000u;
+		float f;
+		std::memcpy(&f, &floatBits, sizeof(f));
+		return f - 3.0f;
+	}
+
+	NoiseGenerator();
+
+	void seed(juce::uint32 seed);
+	void setColour(Colour c);
+	float getNextSample();
+	void renderBlock(float* dest, int numSamples);
+	// Uniform in [0, 1), from the same stream.
+	float nextUnipolar();
+
+private:
+	float nextWhite();
+
+	alignas(32) std::array<juce::uint32, laneCount> lanes{};
+	int nextLane = 0;
+	Colour colour = White;
+	ColourFilter filter;
+};
\ No newline at end of file
@@ -1,14 +1,121 @@
 #include "Oscillator.h"
+#include "WavetableBank.h"
+#include "OscillatorKernels.h"
 
-Oscillator::Oscillator() {}
+namespace {
+	using namespace OscillatorKernels;
+
+	// Runs scalarFn over the unaligned head and tail of data and vectorFn over the aligned middle.
+	template <typename ScalarFn, typename VectorFn>
+	void applyKernel(float* data, int numSamples, ScalarFn scalarFn, VectorFn vectorFn) {
+		const int head = juce::jmin(numSamples, static_cast<int>(Vec::getNextSIMDAlignedPtr(data) - data));
+		const int step = static_cast<int>(Vec::size());
+
+		int i = 0;
+		for (; i < head; ++i)
+			data[i] = scalarFn(data[i]);
+
+		for (; i + step <= numSamples; i += step)
+			vectorFn(Vec::fromRawArray(data + i)).copyToRawArray(data + i);
+
+		for (; i < numSamples; ++i)
+			data[i] = scalarFn(data[i]);
+	}
+
+	float wrapUnit(float p) {
+		return p - static_cast<float>(static_cast<int>(p));
+	}
+
+	// Two-sample polynomial residual of a band-limited step of height 2 located at phase 0.
+	float polyBlep(float t, float dt) {
+		if (t < dt) {
+			t /= dt;
+			return t + t - t * t - 1.0f;
+		}
+		if (t > 1.0f - dt) {
+			t = (t - 1.0f) / dt;
+			return t * t + t + t + 1.0f;
+		}
+		return 0.0f;
+	}
+
+	// Integrated polyBlep: residual of a band-limited unit change of slope (per sample) at phase 0.
+	float polyBlamp(float t, float dt) {
+		if (t < dt)
+			t = 1.0f - t / dt;
+		else if (t > 1.0f - dt)
+			t = 1.0f + (t - 1.0f) / dt;
+		else
+			return 0.0f;
+		return t * t * t * (1.0f / 6.0f);
+	}
+
+	float sawResidual(float p, float dt) {
+		return polyBlep(p, dt);
+	}
+
+	float pulseResidual(float p, float dt, float pw) {
+		return polyBlep(p, dt) - polyBlep(wrapUnit(p + 1.0f - pw), dt);
+	}
+
+	float triangleResidual(float p, float dt) {
+		// Slope flips by +/-8 per cycle at the two corners.
+		return 8.0f * dt * (polyBlamp(p, dt) - polyBlamp(wrapUnit(p + 0.5f), dt));
+	}
+
+	// Above Nyquist the residual windows of the unison copies would overlap; their increments
+	// (not their fixed-point steps) are clamped like applyPolyBlep's.
+	constexpr float maxUnisonInc = 0.5f;
+	constexpr int unisonLanes = static_cast<int>(Vec::SIMDNumElements);
+	constexpr int maxUnisonGroups = Oscillator::maxUnison / unisonLanes;
+
+	// Renders numGroups registers of unison copies, each lane its own copy, and sums them into
+	// left and right through the per-copy pan gains. Each copy's step glides by its stepDelta
+	// per sample. waveFn(phase, group, sample) shapes one register.
+	template <typename WaveFn>
+	void renderCopies(float* left, float* right, int numSamples, juce::uint32* phases, const juce::uint32* startSteps,
+		const juce::uint32* stepDeltas, const float* gainsLeft, const float* gainsRight, int numGroups, WaveFn waveFn) {
+		Vec gl[maxUnisonGroups], gr[maxUnisonGroups];
+		alignas(64) juce::uint32 steps[Oscillator::maxUnison];
+		for (int g = 0; g < numGroups; ++g) {
+			gl[g] = Vec::fromRawArray(gainsLeft + g * unisonLanes);
+			gr[g] = Vec::fromRawArray(gainsRight + g * unisonLanes);
+		}
+		for (int k = 0; k < numGroups * unisonLanes; ++k)
+			steps[k] = startSteps[k] + stepDeltas[k];
+
+		for (int i = 0; i < numSamples; ++i) {
+			Vec l = Vec::expand(0.0f);
+			Vec r = Vec::expand(0.0f);
+			for (int g = 0; g < numGroups; ++g) {
+				const int base = g * unisonLanes;
+				const Vec s = waveFn(nextUnitPhases(phases + base, steps + base, stepDeltas + base), g, i);
+				l += s * gl[g];
+				r += s * gr[g];
+			}
+			left[i] = l.sum();
+			right[i] = r.sum();
+		}
+	}
+}
+
+Oscillator::Oscillator() {
+	updateUnisonRatios();
+	updateUnisonGains();
+}
 
 void Oscillator::setSampleRate(double sr) {
 	sampleRate = (sr > 0.0) ? sr : 44100.0;
+	levelSmoothed.reset(sampleRate, smoothingSeconds);
+	pulseWidthSmoothed.reset(sampleRate, smoothingSeconds);
 	updatePhaseIncrement();
 }
 
 void Oscillator::setFrequency(float freq) {
-	frequency = juce::jmax(0.0f, freq);
+	freq = juce::jmax(0.0f, freq);
+	if (freq == frequency)
+		return;
+	frequency = freq;
 	updatePhaseIncrement();
 }
 
@@ -16,79 +123,496 @@ void Oscillator::setWaveform(Waveform wf) {
 	waveform = wf;
 }
 
+void Oscillator::setQuality(Quality q) {
+	quality = q;
+}
+
+void Oscillator::setWavetableBank(const WavetableBank* bank) {
+	wavetables = bank;
+}
+
 void Oscillator::setLevel(float lvl) {
-	level = juce::jlimit(0.0f, 1.0f, lvl);
+	levelSmoothed.setTargetValue(juce::jlimit(0.0f, 1.0f, lvl));
 }
 
 void Oscillator::setCoarse(int semis) {
+	if (semis == coarse)
+		return;
 	coarse = semis;
-	updatePhaseIncrement();
+	updatePitchRatio();
 }
 
 void Oscillator::setFinetune(float cents) {
-	fine = juce::jlimit(-100.0f, 100.0f, cents);
-	updatePhaseIncrement();
+	cents = juce::jlimit(-100.0f, 100.0f, cents);
+	if (cents == fine)
+		return;
+	fine = cents;
+	updatePitchRatio();
+}
+
+void Oscillator::setPitchModulation(float semitones) {
+	if (semitones == pitchModulation)
+		return;
+	pitchModulation = semitones;
+	updatePitchRatio();
 }
 
 void Oscillator::setPhaseOffset(float offset) {
-	phase = offset;
-	wrapPhase();
+	phase = toFixedPhase(offset);
 }
 
 void Oscillator::setPulseWidth(float pw) {
-	pulseWidth = juce::jlimit(0.01f, 0.99f, pw);
+	pulseWidthSmoothed.setTargetValue(juce::jlimit(0.01f, 0.99f, pw));
 }
 
 void Oscillator::setDetuneSpread(float speedHz) {
-	detuneSpread = juce::jmax(0.0f, speedHz);
+	speedHz = juce::jmax(0.0f, speedHz);
+	if (speedHz == detuneSpread)
+		return;
+	detuneSpread = speedHz;
+	updatePhaseIncrement();
+}
+
+void Oscillator::setUnison(int numVoices, float spreadCents, float blend) {
+	numVoices = juce::jlimit(1, maxUnison, numVoices);
+	spreadCents = juce::jmax(0.0f, spreadCents);
+	blend = juce::jlimit(0.0f, 1.0f, blend);
+
+	const bool voicesChanged = numVoices != unisonVoices;
+	if (voicesChanged) {
+		// Copies start at random phases so a new stack doesn't begin as one phase-aligned spike.
+		for (int k = unisonVoices; k < numVoices; ++k)
+			unisonPhase[static_cast<size_t>(k)] = toFixedPhase(noise.nextUnipolar());
+		unisonVoices = numVoices;
+	}
+
+	if (voicesChanged || spreadCents != unisonSpread) {
+		unisonSpread = spreadCents;
+		updateUnisonRatios();
+	}
+	if (voicesChanged || blend != unisonBlend) {
+		unisonBlend = blend;
+		updateUnisonGains();
+	}
+}
+
+void Oscillator::setNoiseColour(NoiseGenerator::Colour colour) {
+	noise.setColour(colour);
+}
+
+void Oscillator::seedNoise(juce::uint32 seed) {
+	noise.seed(seed);
+}
+
+void Oscillator::skipSmoothing() {
+	levelSmoothed.setCurrentAndTargetValue(levelSmoothed.getTargetValue());
+	pulseWidthSmoothed.setCurrentAndTargetValue(pulseWidthSmoothed.getTargetValue());
+	pulseWidth = pulseWidthSmoothed.getTargetValue();
+	phaseStep = targetStep;
+	unisonStep = unisonTargetStep;
+}
+
+bool Oscillator::isSilent() const {
+	return levelSmoothed.getTargetValue() == 0.0f && !levelSmoothed.isSmoothing();
+}
+
+void Oscillator::advance(int numSamples) {
+	if (numSamples <= 0)
+		return;
+
+	beginBlock(numSamples);
+	for (size_t k = 0; k < static_cast<size_t>(unisonVoices); ++k)
+		unisonPhase[k] = rampPhase(unisonPhase[k], unisonStep[k], getStepDelta(unisonStep[k], unisonTargetStep[k], numSamples), numSamples);
+	endBlock(numSamples);
+	levelSmoothed.skip(numSamples);
 }
 
 float Oscillator::getNextSample() {
+	if (pulseWidthSmoothed.isSmoothing())
+		pulseWidth = pulseWidthSmoothed.getNextValue();
+	phaseStep = targetStep; // a single sample leaves nothing to glide across
+
+	if (usesWavetable()) {
+		const float sample = lookupTable(phase);
+		phase += phaseStep;
+		return sample * levelSmoothed.getNextValue();
+	}
+
+	const float p = toUnitPhase(phase);
 	float sample = 0.0f;
 	const float twoPi = static_cast<float>(juce::MathConstants<double>::twoPi);
 
 	switch (waveform) {
 	case Sine:
-		sample = std::sin(phase * twoPi);
+		sample = std::sin(p * twoPi);
 		break;
 	case Saw:
-		sample = 1.0f - 2.0f * phase;
+		sample = 1.0f - 2.0f * p;
 		break;
 	case Square:
-		sample = (phase < 0.5f) ? 1.0f : -1.0f;
+		sample = (p < 0.5f) ? 1.0f : -1.0f;
 		break;
 	case Triangle:
-		if (phase < 0.5f)
-			sample = -1.0f + 4.0f * phase;
+		if (p < 0.5f)
+			sample = -1.0f + 4.0f * p;
 		else
-			sample = 3.0f - 4.0f * phase;
+			sample = 3.0f - 4.0f * p;
 		break;
 	case Pulse:
-		sample = (phase < pulseWidth) ? 1.0f : -1.0f;
+		sample = (p < pulseWidth) ? 1.0f : -1.0f;
 		break;
 	case Noise:
-		sample = random.nextFloat() * 2.0f - 1.0f;
+		sample = noise.getNextSample();
+		break;
+	default: jassertfalse; break;
+	}
+
+	if (quality == PolyBLEP)
+		sample += getBlepResidual(p);
+
+	phase += phaseStep;
+
+	return sample * levelSmoothed.getNextValue();
+}
+
+void Oscillator::renderBlock(float* dest, int numSamples) {
+	if (numSamples <= 0)
+		return;
+
+	beginBlock(numSamples);
+
+	if (waveform == Noise) {
+		noise.renderBlock(dest, numSamples);
+	} else if (usesWavetable()) {
+		renderFromTable(dest, numSamples);
+	} else {
+		fillPhaseRamp(dest, numSamples);
+
+		switch (waveform) {
+		case Sine:
+			applyKernel(dest, numSamples,
+				[](float p) { return fastSine(p); },
+				[](Vec p) { return fastSine(p); });
+			break;
+		case Saw:
+			applyKernel(dest, numSamples,
+				[](float p) { return 1.0f - 2.0f * p; },
+				[](Vec p) { return Vec::expand(1.0f) - p * 2.0f; });
+			break;
+		case Square:
+			applyKernel(dest, numSamples,
+				[](float p) { return (p < 0.5f) ? 1.0f : -1.0f; },
+				[](Vec p) { return vecStep(p, Vec::expand(0.5f)); });
+			break;
+		case Triangle:
+			applyKernel(dest, numSamples,
+				[](float p) { return 1.0f - 4.0f * std::abs(p - 0.5f); },
+				[](Vec p) { return Vec::expand(1.0f) - vecAbs(p - 0.5f) * 4.0f; });
+			break;
+		case Pulse: {
+			if (pulseWidthDelta != 0.0f) {
+				for (int i = 0; i < numSamples; ++i)
+					dest[i] = (dest[i] < getPulseWidth(i)) ? 1.0f : -1.0f;
+				break;
+			}
+			const float pw = pulseWidth;
+			const Vec pwVec = Vec::expand(pw);
+			applyKernel(dest, numSamples,
+				[pw](float p) { return (p < pw) ? 1.0f : -1.0f; },
+				[pwVec](Vec p) { return vecStep(p, pwVec); });
+			break;
+		}
+		default: jassertfalse; break;
+		}
+
+		if (quality == PolyBLEP)
+			applyPolyBlep(dest, numSamples);
+	}
+
+	endBlock(numSamples);
+
+	if (levelSmoothed.isSmoothing())
+		levelSmoothed.applyGain(dest, numSamples);
+	else
+		juce::FloatVectorOperations::multiply(dest, levelSmoothed.getTargetValue(), numSamples);
+}
+
+void Oscillator::renderBlock(float* left, float* right, int numSamples) {
+	// Noise has no pitch to detune, so it stays a single mono copy.
+	if (unisonVoices == 1 || waveform == Noise) {
+		renderBlock(left, numSamples);
+		juce::FloatVectorOperations::copy(right, left, numSamples);
+		return;
+	}
+
+	if (numSamples <= 0)
+		return;
+
+	beginBlock(numSamples);
+	renderUnison(left, right, numSamples);
+	endBlock(numSamples);
+
+	if (levelSmoothed.isSmoothing()) {
+		for (int i = 0; i < numSamples; ++i) {
+			const float gain = levelSmoothed.getNextValue();
+			left[i] *= gain;
+			right[i] *= gain;
+		}
+	} else {
+		juce::FloatVectorOperations::multiply(left, levelSmoothed.getTargetValue(), numSamples);
+		juce::FloatVectorOperations::multiply(right, levelSmoothed.getTargetValue(), numSamples);
+	}
+}
+
+void Oscillator::renderUnison(float* left, float* right, int numSamples) {
+	const int numGroups = (unisonVoices + unisonLanes - 1) / unisonLanes;
+
+	Vec inc[maxUnisonGroups], invDt[maxUnisonGroups];
+	for (int g = 0; g < numGroups; ++g) {
+		alignas(sizeof(Vec)) float inverse[unisonLanes];
+		for (int l = 0; l < unisonLanes; ++l)
+			inverse[l] = 1.0f / juce::jmax(unisonInc[static_cast<size_t>(g * unisonLanes + l)], 1.0e-9f);
+		inc[g] = Vec::fromRawArray(unisonInc.data() + g * unisonLanes);
+		invDt[g] = Vec::fromRawArray(inverse);
+	}
+
+	alignas(64) juce::uint32 stepDeltas[maxUnison];
+	for (size_t k = 0; k < static_cast<size_t>(numGroups * unisonLanes); ++k)
+		stepDeltas[k] = getStepDelta(unisonStep[k], unisonTargetStep[k], numSamples);
+
+	auto render = [&](auto waveFn) {
+		renderCopies(left, right, numSamples, unisonPhase.data(), unisonStep.data(), stepDeltas,
+			unisonLeft.data(), unisonRight.data(), numGroups, waveFn);
+	};
+
+	if (usesWavetable()) {
+		// Each copy needs its own mip level, so the table reads are gathered lane by lane.
+		const float* tables[maxUnison];
+		for (int k = 0; k < numGroups * unisonLanes; ++k)
+			tables[k] = wavetables->getTable(waveform, unisonInc[static_cast<size_t>(k)]);
+
+		const bool isPulse = waveform == Pulse;
+
+		render([&](Vec x, int g, int i) {
+			const float pw = getPulseWidth(i);
+			const float shift = 1.0f - pw;
+			const float pulseOffset = 2.0f * pw - 1.0f;
+			alignas(sizeof(Vec)) float lanes[unisonLanes];
+			x.copyToRawArray(lanes);
+			for (int l = 0; l < unisonLanes; ++l) {
+				const float* table = tables[g * unisonLanes + l];
+				const float q = lanes[l];
+				lanes[l] = isPulse
+					? WavetableBank::lookup(table, q) - WavetableBank::lookup(table, wrapUnit(q + shift)) + pulseOffset
+					: WavetableBank::lookup(table, q);
+			}
+			return Vec::fromRawArray(lanes);
+		});
+		return;
+	}
+
+	const bool blep = quality == PolyBLEP;
+	const Vec one = Vec::expand(1.0f);
+	const Vec half = Vec::expand(0.5f);
+
+	// Same shapes and residuals as the mono path, with a separate increment per copy. The
+	// pulse width glides across the block, so its shapes take the sample index too.
+	auto run = [&](auto naive, auto residual) {
+		if (blep)
+			render([&](Vec x, int g, int i) { return naive(x, i) + residual(x, g, i); });
+		else
+			render([&](Vec x, int, int i) { return naive(x, i); });
+	};
+
+	switch (waveform) {
+	case Sine:
+		render([](Vec x, int, int) { return fastSine(x); });
+		break;
+	case Saw:
+		run([&](Vec x, int) { return one - x * 2.0f; },
+			[&](Vec x, int g, int) { return vecPolyBlep(x, inc[g], invDt[g]); });
+		break;
+	case Square:
+		run([&](Vec x, int) { return vecStep(x, half); },
+			[&](Vec x, int g, int) { return vecPolyBlep(x, inc[g], invDt[g]) - vecPolyBlep(vecWrap(x + half), inc[g], invDt[g]); });
+		break;
+	case Triangle:
+		run([&](Vec x, int) { return one - vecAbs(x - half) * 4.0f; },
+			[&](Vec x, int g, int) { return inc[g] * 8.0f * (vecPolyBlamp(x, inc[g], invDt[g]) - vecPolyBlamp(vecWrap(x + half), inc[g], invDt[g])); });
+		break;
+	case Pulse:
+		run([&](Vec x, int i) { return vecStep(x, Vec::expand(getPulseWidth(i))); },
+			[&](Vec x, int g, int i) { return vecPolyBlep(x, inc[g], invDt[g]) - vecPolyBlep(vecWrap(x + (1.0f - getPulseWidth(i))), inc[g], invDt[g]); });
 		break;
 	default: jassertfalse; break;
 	}
+}
+
+void Oscillator::applyPolyBlep(float* dest, int numSamples) const {
+	// Above Nyquist the residual windows would overlap; clamp and accept the aliasing.
+	const float dt = juce::jmin(phaseInc, 0.5f);
+	if (dt <= 0.0f)
+		return;
+
+	// Walks the same phases as fillPhaseRamp. Only samples within one increment of a
+	// discontinuity get a non-zero residual, so these scalar passes are mostly compares.
+	auto addResidual = [&](auto residualFn) {
+		for (int i = 0; i < numSamples; ++i)
+			dest[i] += residualFn(toUnitPhase(getPhase(i)), i);
+	};
+
+	switch (waveform) {
+	case Saw:
+		addResidual([dt](float p, int) { return sawResidual(p, dt); });
+		break;
+	case Square:
+		addResidual([dt](float p, int) { return pulseResidual(p, dt, 0.5f); });
+		break;
+	case Pulse:
+		addResidual([this, dt](float p, int i) { return pulseResidual(p, dt, getPulseWidth(i)); });
+		break;
+	case Triangle:
+		addResidual([dt](float p, int) { return triangleResidual(p, dt); });
+		break;
+	default: break;
+	}
+}
+
+float Oscillator::getBlepResidual(float p) const {
+	const float dt = juce::jmin(phaseInc, 0.5f);
+	if (dt <= 0.0f)
+		return 0.0f;
+
+	switch (waveform) {
+	case Saw:      return sawResidual(p, dt);
+	case Square:   return pulseResidual(p, dt, 0.5f);
+	case Pulse:    return pulseResidual(p, dt, pulseWidth);
+	case Triangle: return triangleResidual(p, dt);
+	default:       return 0.0f;
+	}
+}
 
-	phase += phaseInc;
-	wrapPhase();
+bool Oscillator::usesWavetable() const {
+	return quality == Wavetable && waveform != Noise && wavetables != nullptr && wavetables->isBuilt();
+}
+
+void Oscillator::renderFromTable(float* dest, int numSamples) {
+	const float* table = wavetables->getTable(waveform, phaseInc);
+
+	if (waveform == Pulse) {
+		// Difference of two band-limited saws offset by the pulse width, recentred to +/-1. The
+		// offset glides with the width, in fixed point like the phase.
+		const juce::uint32 shiftStart = toFixedPhase(1.0 - pulseWidthStart);
+		const auto shiftDelta = static_cast<juce::uint32>(static_cast<juce::int64>(-static_cast<double>(pulseWidthDelta) * 4294967296.0));
+		for (int i = 0; i < numSamples; ++i) {
+			const juce::uint32 p = getPhase(i);
+			const juce::uint32 shift = shiftStart + shiftDelta * static_cast<juce::uint32>(i + 1);
+			dest[i] = WavetableBank::lookup(table, p) - WavetableBank::lookup(table, p + shift) + 2.0f * getPulseWidth(i) - 1.0f;
+		}
+	} else {
+		for (int i = 0; i < numSamples; ++i)
+			dest[i] = WavetableBank::lookup(table, getPhase(i));
+	}
+}
+
+float Oscillator::lookupTable(juce::uint32 p) const {
+	const float* table = wavetables->getTable(waveform, phaseInc);
+	if (waveform == Pulse)
+		return WavetableBank::lookup(table, p) - WavetableBank::lookup(table, p + toFixedPhase(1.0 - pulseWidth))
+			+ 2.0f * pulseWidth - 1.0f;
+	return WavetableBank::lookup(table, p);
+}
+
+void Oscillator::fillPhaseRamp(float* dest, int numSamples) const {
+	// Each sample's phase is computed from the block start, so the loop has no carried
+	// dependency and vectorises; unsigned overflow does the wrapping.
+	for (int i = 0; i < numSamples; ++i)
+		dest[i] = toUnitPhase(getPhase(i));
+}
 
-	return sample * level;
+void Oscillator::beginBlock(int numSamples) {
+	stepDelta = getStepDelta(phaseStep, targetStep, numSamples);
+	pulseWidthStart = pulseWidth;
+	if (pulseWidthSmoothed.isSmoothing())
+		pulseWidth = pulseWidthSmoothed.skip(numSamples);
+	pulseWidthDelta = (pulseWidth - pulseWidthStart) / static_cast<float>(numSamples);
+}
+
+void Oscillator::endBlock(int numSamples) {
+	phase = getPhase(numSamples);
+	phaseStep = targetStep;
+	unisonStep = unisonTargetStep;
+	stepDelta = 0;
+	pulseWidthStart = pulseWidth;
+	pulseWidthDelta = 0.0f;
+}
+
+juce::uint32 Oscillator::getPhase(int i) const {
+	return rampPhase(phase, phaseStep, stepDelta, i);
+}
+
+float Oscillator::getPulseWidth(int i) const {
+	return pulseWidthStart + pulseWidthDelta * static_cast<float>(i + 1);
+}
+
+void Oscillator::updatePitchRatio() {
+	pitchRatio = std::exp2((static_cast<float>(coarse) * 100.0f + fine) / 1200.0f + pitchModulation / 12.0f);
+	updatePhaseIncrement();
 }
 
 void Oscillator::updatePhaseIncrement() {
-	float semitoneRatio = std::pow(2.0f, coarse / 12.0f);
-	float centsRatio = std::pow(2.0f, fine / 1200.0f);
-	float adjustedFrequency = (frequency * semitoneRatio * centsRatio) + detuneSpread;
+	const double adjustedFrequency = static_cast<double>(frequency * pitchRatio) + detuneSpread;
+	const double cyclesPerSample = adjustedFrequency / sampleRate;
 
-	phaseInc = adjustedFrequency / static_cast<float>(sampleRate);
+	phaseInc = static_cast<float>(cyclesPerSample);
+	targetStep = toFixedPhase(cyclesPerSample);
+	updateUnisonIncrements();
 }
 
-void Oscillator::wrapPhase() {
-	while (phase >= 1.0f)
-		phase -= 1.0f;
-	while (phase < 0.0f)
-		phase += 1.0f;
+void Oscillator::updateUnisonRatios() {
+	// Copies sit evenly from -spread to +spread cents around the oscillator pitch.
+	for (int k = 0; k < maxUnison; ++k) {
+		float ratio = 0.0f;
+		if (k < unisonVoices) {
+			const float position = (unisonVoices > 1) ? 2.0f * static_cast<float>(k) / static_cast<float>(unisonVoices - 1) - 1.0f : 0.0f;
+			ratio = std::exp2(position * unisonSpread / 1200.0f);
+		}
+		unisonRatio[static_cast<size_t>(k)] = ratio;
+	}
+	updateUnisonIncrements();
+}
+
+void Oscillator::updateUnisonGains() {
+	// The centre copy (or middle pair) carries 1 - blend and the others blend, normalised to
+	// constant power. Pans run equal-power from hard left to hard right, scaled so a centred
+	// copy has unity gain in both channels.
+	const int n = unisonVoices;
+	float weights[maxUnison] = {};
+	float power = 0.0f;
+	for (int k = 0; k < n; ++k) {
+		const bool centre = k == (n - 1) / 2 || k == n / 2;
+		weights[k] = (n <= 2) ? 1.0f : (centre ? 1.0f - unisonBlend : unisonBlend);
+		power += weights[k] * weights[k];
+	}
+	const float norm = (power > 0.0f) ? 1.0f / std::sqrt(power) : 0.0f;
+
+	for (int k = 0; k < maxUnison; ++k) {
+		const auto i = static_cast<size_t>(k);
+		if (k < n && n > 1) {
+			const float pan = 2.0f * static_cast<float>(k) / static_cast<float>(n - 1) - 1.0f;
+			const float angle = (pan + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
+			unisonLeft[i] = norm * weights[k] * juce::MathConstants<float>::sqrt2 * std::cos(angle);
+			unisonRight[i] = norm * weights[k] * juce::MathConstants<float>::sqrt2 * std::sin(angle);
+		} else {
+			unisonLeft[i] = unisonRight[i] = (k < n) ? 1.0f : 0.0f;
+		}
+	}
+}
+
+void Oscillator::updateUnisonIncrements() {
+	for (int k = 0; k < maxUnison; ++k) {
+		const auto i = static_cast<size_t>(k);
+		unisonTargetStep[i] = toFixedPhase(static_cast<double>(phaseInc) * unisonRatio[i]);
+		unisonInc[i] = juce::jmin(phaseInc * unisonRatio[i], maxUnisonInc);
+	}
 }
\ No newline at end of file
@@ -1,35 +1,103 @@
 #pragma once
 #include <JuceHeader.h>
+#include "NoiseGenerator.h"
+
+class WavetableBank;
 
 class Oscillator {
 public:
 	enum Waveform { Sine, Saw, Square, Triangle, Pulse, Noise };
+	enum Quality { Naive, PolyBLEP, Wavetable };
+	static constexpr int maxUnison = 16;
+
 	Oscillator();
 	void setSampleRate(double sr);
 	void setFrequency(float freq);
 	void setWaveform(Waveform wf);
+	void setQuality(Quality q);
+	void setWavetableBank(const WavetableBank* bank);
 	void setLevel(float lvl);
 	void setCoarse(int semis);
 	void setFinetune(float cents);
+	// Offset from the mod matrix on top of coarse and fine, unclamped.
+	void setPitchModulation(float semitones);
 	void setPhaseOffset(float offset);
 	void setPulseWidth(float pw);
 	void setDetuneSpread(float speedHz);
+	// Stacks numVoices copies detuned evenly across +/- spreadCents and panned across the
+	// stereo field. blend moves level from the centre copies (0) to the outer ones (1).
+	void setUnison(int numVoices, float spreadCents, float blend);
+	void setNoiseColour(NoiseGenerator::Colour colour);
+	// Restarts the noise stream (also used for unison start phases), see NoiseGenerator::makeSeed.
+	void seedNoise(juce::uint32 seed);
+	void skipSmoothing();
+	bool isSilent() const;
 	float getNextSample();
+	// Moves on by numSamples as if they had been rendered, without producing them.
+	void advance(int numSamples);
+	void renderBlock(float* dest, int numSamples);
+	void renderBlock(float* left, float* right, int numSamples);
 
 private:
+	void updatePitchRatio();
 	void updatePhaseIncrement();
-	void wrapPhase();
+	// A rendered block glides the phase steps and pulse width to their targets; phase,
+	// phaseStep and pulseWidthStart stay at the block start until endBlock.
+	void beginBlock(int numSamples);
+	void endBlock(int numSamples);
+	juce::uint32 getPhase(int sample) const;
+	float getPulseWidth(int sample) const;
+	void fillPhaseRamp(float* dest, int numSamples) const;
+	void applyPolyBlep(float* dest, int numSamples) const;
+	float getBlepResidual(float p) const;
+	bool usesWavetable() const;
+	void renderFromTable(float* dest, int numSamples);
+	float lookupTable(juce::uint32 p) const;
+	void updateUnisonRatios();
+	void updateUnisonGains();
+	void updateUnisonIncrements();
+	void renderUnison(float* left, float* right, int numSamples);
 
 	double sampleRate{ 44100.0 };
 	float  frequency{ 440.0f };
-	float  phase{ 0.0f };
+	// Fixed-point phase, one cycle per 2^32, wrapping by unsigned overflow, so its resolution
+	// doesn't depend on where in the cycle it is and long notes don't drift. phaseInc is the
+	// same increment in cycles, for the PolyBLEP widths and the wavetable mip choice. Pitch
+	// changes set targetStep, and the next rendered block ramps phaseStep there linearly,
+	// stepDelta per sample, so modulation doesn't jump once per control period.
+	juce::uint32 phase{ 0 };
+	juce::uint32 phaseStep{ 0 };
+	juce::uint32 targetStep{ 0 };
+	juce::uint32 stepDelta{ 0 };
 	float  phaseInc{ 0.0f };
-	float  level{ 0.0f };
 	int    coarse{ 0 };
 	float  fine{ 0.0f };
+	float  pitchModulation{ 0.0f }; // semitones
+	float  pitchRatio{ 1.0f };
 	float  pulseWidth{ 0.5f };
+	float  pulseWidthStart{ 0.5f };
+	float  pulseWidthDelta{ 0.0f }; // per sample across the block being rendered
 	float  detuneSpread{ 0.0f };
 
+	// Unison copies, one array slot each; slots past unisonVoices keep zero gain and increment
+	// so whole registers can be rendered. Phases and steps are fixed point like phase.
+	int    unisonVoices{ 1 };
+	float  unisonSpread{ 0.0f };
+	float  unisonBlend{ 0.5f };
+	alignas(64) std::array<juce::uint32, maxUnison> unisonPhase{};
+	alignas(64) std::array<juce::uint32, maxUnison> unisonStep{};
+	alignas(64) std::array<juce::uint32, maxUnison> unisonTargetStep{};
+	alignas(64) std::array<float, maxUnison> unisonInc{};
+	alignas(64) std::array<float, maxUnison> unisonRatio{};
+	alignas(64) std::array<float, maxUnison> unisonLeft{};
+	alignas(64) std::array<float, maxUnison> unisonRight{};
+
+	static constexpr double smoothingSeconds = 0.02;
+	juce::SmoothedValue<float> levelSmoothed{ 0.0f };
+	juce::SmoothedValue<float> pulseWidthSmoothed{ 0.5f };
+
 	Waveform waveform = Sine;
-	juce::Random random;
+	Quality  quality = PolyBLEP;
+	const WavetableBank* wavetables{ nullptr };
+	NoiseGenerator noise;
 };
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Waveform math shared by Oscillator and VoiceBank, written once for floats and SIMD registers.
+namespace OscillatorKernels {
+	using Vec = juce::dsp::SIMDRegister<float>;
+
+	// Fixed-point phases hold one cycle per 2^32 and wrap by unsigned overflow.
+	// Cycles (any sign or size) to the nearest fixed-point phase; only the fraction matters.
+	inline juce::uint32 toFixedPhase(double cycles) {
+		return static_cast<juce::uint32>(static_cast<juce::uint64>((cycles - std::floor(cycles)) * 4294967296.0 + 0.5));
+	}
+
+	// The top 24 bits, which a float in [0, 1) holds exactly.
+	inline float toUnitPhase(juce::uint32 phase) {
+		return static_cast<float>(phase >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// One register of fixed-point phases as floats in [0, 1), each advanced by its own step.
+	inline Vec nextUnitPhases(juce::uint32* phases, const juce::uint32* steps) {
+		alignas(sizeof(Vec)) float unit[Vec::SIMDNumElements];
+		for (size_t l = 0; l < Vec::SIMDNumElements; ++l) {
+			unit[l] = toUnitPhase(phases[l]);
+			phases[l] += steps[l];
+		}
+		return Vec::fromRawArray(unit);
+	}
+
+	// Same, with each step then moving on by its own delta, for a pitch that glides across a block.
+	inline Vec nextUnitPhases(juce::uint32* phases, juce::uint32* steps, const juce::uint32* stepDeltas) {
+		const Vec unit = nextUnitPhases(phases, steps);
+		for (size_t l = 0; l < Vec::SIMDNumElements; ++l)
+			steps[l] += stepDeltas[l];
+		return unit;
+	}
+
+	// Per-sample change of a fixed-point step that takes it from `from` to `to` over numSamples
+	// samples. The difference is read as signed, so a falling pitch wraps round to the right sum.
+	inline juce::uint32 getStepDelta(juce::uint32 from, juce::uint32 to, int numSamples) {
+		return static_cast<juce::uint32>(static_cast<juce::int32>(to - from) / numSamples);
+	}
+
+	// Phase i samples into a block that starts at `start` with a step gliding by stepDelta per
+	// sample: start plus step + stepDelta * (j + 1) summed over the samples j before i. It needs
+	// nothing from earlier samples, so loops over it have no carried dependency.
+	inline juce::uint32 rampPhase(juce::uint32 start, juce::uint32 step, juce::uint32 stepDelta, int i) {
+		const auto n = static_cast<juce::uint64>(i);
+		return start + step * static_cast<juce::uint32>(n) + stepDelta * static_cast<juce::uint32>(n * (n + 1) / 2);
+	}
+
+	// sin(2*pi*phase) for phase in [0, 1). With t = 2 * phase - 1 the result is -sin(pi * t), which is
+	// approximated as t * (1 - t^2) * P(t^2) so the zero crossings stay exact (max error ~2e-7).
+	constexpr float sineC0 = 3.14159160f;
+	constexpr float sineC1 = -2.02609000f;
+	constexpr float sineC2 = 0.52381338f;
+	constexpr float sineC3 = -0.07452091f;
+	constexpr float sineC4 = 0.00601023f;
+
+	template <typename T>
+	inline T fastSine(T phase) {
+		const T t = phase * 2.0f - 1.0f;
+		const T t2 = t * t;
+		const T poly = (((t2 * sineC4 + sineC3) * t2 + sineC2) * t2 + sineC1) * t2 + sineC0;
+		return t * (t2 - 1.0f) * poly;
+	}
+
+	inline Vec vecAbs(Vec v) {
+		return Vec::max(v, Vec::expand(0.0f) - v);
+	}
+
+	// +1 where phase < threshold, -1 elsewhere.
+	inline Vec vecStep(Vec phase, Vec threshold) {
+		return (Vec::expand(2.0f) & Vec::lessThan(phase, threshold)) - Vec::expand(1.0f);
+	}
+
+	// Wraps phases in [0, 2) back into [0, 1).
+	inline Vec vecWrap(Vec p) {
+		const Vec one = Vec::expand(1.0f);
+		return p - (one & Vec::greaterThanOrEqual(p, one));
+	}
+
+	// Branch-free versions of polyBlep and polyBlamp in Oscillator.cpp, with a separate increment per lane.
+	inline Vec vecPolyBlep(Vec t, Vec dt, Vec invDt) {
+		const Vec one = Vec::expand(1.0f);
+		const Vec a = t * invDt;
+		const Vec b = (t - one) * invDt;
+		const Vec early = a + a - a * a - one;
+		const Vec late = b * b + b + b + one;
+		return (early & Vec::lessThan(t, dt)) + (late & Vec::greaterThan(t, one - dt));
+	}
+
+	inline Vec vecPolyBlamp(Vec t, Vec dt, Vec invDt) {
+		const Vec one = Vec::expand(1.0f);
+		const Vec x = ((one - t * invDt) & Vec::lessThan(t, dt))
+			+ ((one + (t - one) * invDt) & Vec::greaterThan(t, one - dt));
+		return x * x * x * (1.0f / 6.0f);
+	}
+}
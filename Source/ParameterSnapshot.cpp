@@ -0,0 +1,129 @@
+#include "ParameterSnapshot.h"
+
+ParameterCache::ParameterCache(juce::AudioProcessorValueTreeState& apvts) {
+	attack = apvts.getRawParameterValue("ampAttack");
+	hold = apvts.getRawParameterValue("ampHold");
+	decay = apvts.getRawParameterValue("ampDecay");
+	sustain = apvts.getRawParameterValue("ampSustain");
+	release = apvts.getRawParameterValue("ampRelease");
+	ampCurve = apvts.getRawParameterValue("ampCurve");
+	filterType = apvts.getRawParameterValue("filterType");
+	filterCutoff = apvts.getRawParameterValue("filterCutoff");
+	filterResonance = apvts.getRawParameterValue("filterResonance");
+	filterEnvAmount = apvts.getRawParameterValue("filterEnvAmount");
+	filterModRate = apvts.getRawParameterValue("filterModRate");
+	filterAttack = apvts.getRawParameterValue("filterAttack");
+	filterHold = apvts.getRawParameterValue("filterHold");
+	filterDecay = apvts.getRawParameterValue("filterDecay");
+	filterSustain = apvts.getRawParameterValue("filterSustain");
+	filterRelease = apvts.getRawParameterValue("filterRelease");
+	oscQuality = apvts.getRawParameterValue("oscQuality");
+	masterGain = apvts.getRawParameterValue("masterGain");
+	polyphony = apvts.getRawParameterValue("polyphony");
+	voiceSteal = apvts.getRawParameterValue("voiceSteal");
+	oversampling = apvts.getRawParameterValue("oversampling");
+	parallelVoices = apvts.getRawParameterValue("parallelVoices");
+	voiceBank = apvts.getRawParameterValue("voiceBank");
+	modAttack = apvts.getRawParameterValue("modAttack");
+	modHold = apvts.getRawParameterValue("modHold");
+	modDecay = apvts.getRawParameterValue("modDecay");
+	modSustain = apvts.getRawParameterValue("modSustain");
+	modRelease = apvts.getRawParameterValue("modRelease");
+	modControlRate = apvts.getRawParameterValue("modControlRate");
+	voiceSpread = apvts.getRawParameterValue("voiceSpread");
+	mpe = apvts.getRawParameterValue("mpe");
+	mpeBendRange = apvts.getRawParameterValue("mpeBendRange");
+
+	for (int i = 0; i < ParameterSnapshot::numOscillators; ++i) {
+		const juce::String prefix = "osc" + juce::String(i + 1);
+		osc[i].wave = apvts.getRawParameterValue(prefix + "Wave");
+		osc[i].level = apvts.getRawParameterValue(prefix + "Level");
+		osc[i].coarse = apvts.getRawParameterValue(prefix + "Coarse");
+		osc[i].fine = apvts.getRawParameterValue(prefix + "Fine");
+		osc[i].pulseWidth = apvts.getRawParameterValue(prefix + "PW");
+		osc[i].detune = apvts.getRawParameterValue(prefix + "Detune");
+		osc[i].unison = apvts.getRawParameterValue(prefix + "Unison");
+		osc[i].unisonSpread = apvts.getRawParameterValue(prefix + "Spread");
+		osc[i].unisonBlend = apvts.getRawParameterValue(prefix + "Blend");
+		osc[i].noise = apvts.getRawParameterValue(prefix + "Noise");
+		jassert(osc[i].wave != nullptr && osc[i].noise != nullptr);
+	}
+
+	for (int i = 0; i < ModMatrix::numLfos; ++i) {
+		const juce::String prefix = "lfo" + juce::String(i + 1);
+		lfo[i].rate = apvts.getRawParameterValue(prefix + "Rate");
+		lfo[i].shape = apvts.getRawParameterValue(prefix + "Shape");
+		jassert(lfo[i].rate != nullptr && lfo[i].shape != nullptr);
+	}
+
+	for (int i = 0; i < ModMatrix::numSlots; ++i) {
+		const juce::String prefix = "mod" + juce::String(i + 1);
+		slot[i].source = apvts.getRawParameterValue(prefix + "Source");
+		slot[i].destination = apvts.getRawParameterValue(prefix + "Dest");
+		slot[i].amount = apvts.getRawParameterValue(prefix + "Amount");
+		jassert(slot[i].source != nullptr && slot[i].amount != nullptr);
+	}
+}
+
+void ParameterCache::fill(ParameterSnapshot& dest) const {
+	dest.amp.attack = attack->load();
+	dest.amp.hold = hold->load();
+	dest.amp.decay = decay->load();
+	dest.amp.sustain = sustain->load();
+	dest.amp.release = release->load();
+	dest.amp.curve = static_cast<AHDSR::Curve>(static_cast<int>(ampCurve->load()));
+	dest.filter.type = static_cast<VoiceFilter::Type>(static_cast<int>(filterType->load()));
+	dest.filter.cutoff = filterCutoff->load();
+	dest.filter.resonance = filterResonance->load();
+	dest.filter.envAmount = filterEnvAmount->load();
+	dest.filter.blockRate = static_cast<int>(filterModRate->load()) == 1;
+	dest.filter.env.attack = filterAttack->load();
+	dest.filter.env.hold = filterHold->load();
+	dest.filter.env.decay = filterDecay->load();
+	dest.filter.env.sustain = filterSustain->load();
+	dest.filter.env.release = filterRelease->load();
+	dest.filter.env.curve = dest.amp.curve; // one curve setting for both envelopes
+	dest.oscQuality = static_cast<Oscillator::Quality>(static_cast<int>(oscQuality->load()));
+	dest.masterGain = masterGain->load();
+	dest.polyphony = static_cast<int>(polyphony->load());
+	dest.stealPolicy = static_cast<VoiceAllocator::StealPolicy>(static_cast<int>(voiceSteal->load()));
+	dest.oversamplingOrder = static_cast<int>(oversampling->load());
+	dest.parallelVoices = parallelVoices->load() >= 0.5f;
+	dest.voiceBank = voiceBank->load() >= 0.5f;
+	dest.mpe.enabled = mpe->load() >= 0.5f;
+	dest.mpe.noteBendRange = mpeBendRange->load();
+
+	for (int i = 0; i < ParameterSnapshot::numOscillators; ++i) {
+		auto& o = dest.osc[i];
+		o.wave = static_cast<Oscillator::Waveform>(static_cast<int>(osc[i].wave->load()));
+		o.level = osc[i].level->load();
+		o.coarse = static_cast<int>(osc[i].coarse->load());
+		o.fine = osc[i].fine->load();
+		o.pulseWidth = osc[i].pulseWidth->load();
+		o.detune = osc[i].detune->load();
+		o.unison = static_cast<int>(osc[i].unison->load());
+		o.unisonSpread = osc[i].unisonSpread->load();
+		o.unisonBlend = osc[i].unisonBlend->load();
+		o.noise = static_cast<NoiseGenerator::Colour>(static_cast<int>(osc[i].noise->load()));
+	}
+
+	auto& mod = dest.mod;
+	for (int i = 0; i < ModMatrix::numLfos; ++i) {
+		mod.lfo[i].rate = lfo[i].rate->load();
+		mod.lfo[i].shape = static_cast<ModLfo::Shape>(static_cast<int>(lfo[i].shape->load()));
+	}
+	mod.env.attack = modAttack->load();
+	mod.env.hold = modHold->load();
+	mod.env.decay = modDecay->load();
+	mod.env.sustain = modSustain->load();
+	mod.env.release = modRelease->load();
+	mod.env.curve = dest.amp.curve;
+	mod.controlInterval = 8 << static_cast<int>(modControlRate->load());
+	mod.voiceSpread = voiceSpread->load();
+
+	// Source choice 0 is "Off", so the matrix source is one less.
+	mod.routing.clear();
+	for (int i = 0; i < ModMatrix::numSlots; ++i)
+		mod.routing.add(static_cast<int>(slot[i].source->load()) - 1,
+			static_cast<int>(slot[i].destination->load()), slot[i].amount->load());
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <JuceHeader.h>
+#include "AHDSR.h"
+#include "Oscillator.h"
+#include "VoiceFilter.h"
+#include "VoiceAllocator.h"
+#include "ModMatrix.h"
+
+// Plain copy of every synth parameter, refreshed once per block on the audio thread
+// and read by all voices through a const reference.
+struct alignas(64) ParameterSnapshot {
+	static constexpr int numOscillators = 3;
+
+	struct Osc {
+		Oscillator::Waveform wave = Oscillator::Sine;
+		float level = 0.8f;
+		int   coarse = 0;
+		float fine = 0.0f;
+		float pulseWidth = 0.5f;
+		float detune = 0.0f;
+		int   unison = 1;
+		float unisonSpread = 20.0f;
+		float unisonBlend = 0.5f;
+		NoiseGenerator::Colour noise = NoiseGenerator::White;
+	};
+
+	struct Filter {
+		VoiceFilter::Type type = VoiceFilter::Off;
+		float cutoff = 20000.0f;
+		float resonance = 0.1f;
+		float envAmount = 0.0f; // octaves at full envelope
+		bool  blockRate = false; // coefficients once per block instead of per sub-block
+		AHDSR::Params env;
+	};
+
+	struct Modulation {
+		float voiceSpread = 0.0f; // notes pan randomly within +/- this
+		std::array<ModLfo::Params, ModMatrix::numLfos> lfo;
+		AHDSR::Params env;
+		int controlInterval = 32; // samples between matrix evaluations
+		ModMatrix::Routing routing;
+	};
+
+	// MPE lower zone: channel 1 is the master channel, 2 to 16 carry one note each.
+	struct Mpe {
+		bool  enabled = false;
+		float noteBendRange = 48.0f; // semitones of a member channel's pitch bend
+	};
+
+	AHDSR::Params amp;
+	Filter filter;
+	Modulation mod;
+	Mpe mpe;
+	std::array<Osc, numOscillators> osc;
+	Oscillator::Quality oscQuality = Oscillator::PolyBLEP;
+	float masterGain = 0.8f;
+	int   polyphony = 8;
+	VoiceAllocator::StealPolicy stealPolicy = VoiceAllocator::StealPolicy::ReleasedFirst;
+	int   oversamplingOrder = 0; // voices render at 2^order times the host rate
+	bool  parallelVoices = false;
+	bool  voiceBank = false;
+};
+
+// Resolves the apvts parameter IDs once so filling a snapshot is only atomic loads.
+class ParameterCache {
+public:
+	explicit ParameterCache(juce::AudioProcessorValueTreeState& apvts);
+
+	void fill(ParameterSnapshot& dest) const;
+
+private:
+	struct OscParams {
+		std::atomic<float>* wave{ nullptr };
+		std::atomic<float>* level{ nullptr };
+		std::atomic<float>* coarse{ nullptr };
+		std::atomic<float>* fine{ nullptr };
+		std::atomic<float>* pulseWidth{ nullptr };
+		std::atomic<float>* detune{ nullptr };
+		std::atomic<float>* unison{ nullptr };
+		std::atomic<float>* unisonSpread{ nullptr };
+		std::atomic<float>* unisonBlend{ nullptr };
+		std::atomic<float>* noise{ nullptr };
+	};
+
+	struct LfoParams {
+		std::atomic<float>* rate{ nullptr };
+		std::atomic<float>* shape{ nullptr };
+	};
+
+	struct SlotParams {
+		std::atomic<float>* source{ nullptr };
+		std::atomic<float>* destination{ nullptr };
+		std::atomic<float>* amount{ nullptr };
+	};
+
+	std::atomic<float>* attack{ nullptr };
+	std::atomic<float>* hold{ nullptr };
+	std::atomic<float>* decay{ nullptr };
+	std::atomic<float>* sustain{ nullptr };
+	std::atomic<float>* release{ nullptr };
+	std::atomic<float>* ampCurve{ nullptr };
+	std::atomic<float>* filterType{ nullptr };
+	std::atomic<float>* filterCutoff{ nullptr };
+	std::atomic<float>* filterResonance{ nullptr };
+	std::atomic<float>* filterEnvAmount{ nullptr };
+	std::atomic<float>* filterModRate{ nullptr };
+	std::atomic<float>* filterAttack{ nullptr };
+	std::atomic<float>* filterHold{ nullptr };
+	std::atomic<float>* filterDecay{ nullptr };
+	std::atomic<float>* filterSustain{ nullptr };
+	std::atomic<float>* filterRelease{ nullptr };
+	std::atomic<float>* oscQuality{ nullptr };
+	std::atomic<float>* masterGain{ nullptr };
+	std::atomic<float>* polyphony{ nullptr };
+	std::atomic<float>* voiceSteal{ nullptr };
+	std::atomic<float>* oversampling{ nullptr };
+	std::atomic<float>* parallelVoices{ nullptr };
+	std::atomic<float>* voiceBank{ nullptr };
+	std::atomic<float>* modAttack{ nullptr };
+	std::atomic<float>* modHold{ nullptr };
+	std::atomic<float>* modDecay{ nullptr };
+	std::atomic<float>* modSustain{ nullptr };
+	std::atomic<float>* modRelease{ nullptr };
+	std::atomic<float>* modControlRate{ nullptr };
+	std::atomic<float>* voiceSpread{ nullptr };
+	std::atomic<float>* mpe{ nullptr };
+	std::atomic<float>* mpeBendRange{ nullptr };
+	std::array<OscParams, ParameterSnapshot::numOscillators> osc;
+	std::array<LfoParams, ModMatrix::numLfos> lfo;
+	std::array<SlotParams, ModMatrix::numSlots> slot;
+};
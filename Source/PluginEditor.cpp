@@ -17,7 +17,7 @@ static void configKnob(juce::Slider& s) {
 CyqnusAudioProcessorEditor::CyqnusAudioProcessorEditor(CyqnusAudioProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p), keyboardComponent(audioProcessor.keyboardState, juce::MidiKeyboardComponent::horizontalKeyboard)
 {
-    setSize(800, 800);
+    setSize(1500, 960);
     addAndMakeVisible(keyboardComponent);
 
     auto& apvts = audioProcessor.apvts;
@@ -39,6 +39,104 @@ CyqnusAudioProcessorEditor::CyqnusAudioProcessorEditor(CyqnusAudioProcessor& p)
     aRelease = std::make_unique<SliderAttachment>(apvts, "ampRelease", release);
     aGain = std::make_unique<SliderAttachment>(apvts, "masterGain", masterGain);
 
+    oscQuality.addItemList(juce::StringArray{ "Naive", "PolyBLEP", "Wavetable" }, 1);
+    addAndMakeVisible(oscQuality);
+    aOscQuality = std::make_unique<ComboBoxAttachment>(apvts, "oscQuality", oscQuality);
+
+    ampCurve.addItemList(juce::StringArray{ "Linear", "Exponential" }, 1);
+    addAndMakeVisible(ampCurve);
+    aAmpCurve = std::make_unique<ComboBoxAttachment>(apvts, "ampCurve", ampCurve);
+
+    filterType.addItemList(juce::StringArray{ "Off", "Low-pass", "High-pass", "Band-pass" }, 1);
+    addAndMakeVisible(filterType);
+    filterModRate.addItemList(juce::StringArray{ "Sub-block", "Block" }, 1);
+    addAndMakeVisible(filterModRate);
+    configKnob(filterCutoff);    addAndMakeVisible(filterCutoff);
+    configKnob(filterResonance); addAndMakeVisible(filterResonance);
+    configKnob(filterEnvAmount); addAndMakeVisible(filterEnvAmount);
+    configKnob(filterAttack);    addAndMakeVisible(filterAttack);
+    configKnob(filterHold);      addAndMakeVisible(filterHold);
+    configKnob(filterDecay);     addAndMakeVisible(filterDecay);
+    configKnob(filterSustain);   addAndMakeVisible(filterSustain);
+    configKnob(filterRelease);   addAndMakeVisible(filterRelease);
+
+    aFilterType = std::make_unique<ComboBoxAttachment>(apvts, "filterType", filterType);
+    aFilterModRate = std::make_unique<ComboBoxAttachment>(apvts, "filterModRate", filterModRate);
+    aFilterCutoff = std::make_unique<SliderAttachment>(apvts, "filterCutoff", filterCutoff);
+    aFilterResonance = std::make_unique<SliderAttachment>(apvts, "filterResonance", filterResonance);
+    aFilterEnvAmount = std::make_unique<SliderAttachment>(apvts, "filterEnvAmount", filterEnvAmount);
+    aFilterAttack = std::make_unique<SliderAttachment>(apvts, "filterAttack", filterAttack);
+    aFilterHold = std::make_unique<SliderAttachment>(apvts, "filterHold", filterHold);
+    aFilterDecay = std::make_unique<SliderAttachment>(apvts, "filterDecay", filterDecay);
+    aFilterSustain = std::make_unique<SliderAttachment>(apvts, "filterSustain", filterSustain);
+    aFilterRelease = std::make_unique<SliderAttachment>(apvts, "filterRelease", filterRelease);
+
+    polyphony.setSliderStyle(juce::Slider::LinearHorizontal);
+    polyphony.setTextBoxStyle(juce::Slider::TextBoxRight, false, 60, 18);
+    addAndMakeVisible(polyphony);
+    addAndMakeVisible(parallelVoices);
+    aPolyphony = std::make_unique<SliderAttachment>(apvts, "polyphony", polyphony);
+    aParallelVoices = std::make_unique<ButtonAttachment>(apvts, "parallelVoices", parallelVoices);
+    addAndMakeVisible(voiceBank);
+    oversampling.addItemList(juce::StringArray{ "Off", "2x", "4x", "8x" }, 1);
+    addAndMakeVisible(oversampling);
+    aOversampling = std::make_unique<ComboBoxAttachment>(apvts, "oversampling", oversampling);
+    aVoiceBank = std::make_unique<ButtonAttachment>(apvts, "voiceBank", voiceBank);
+    voiceSteal.addItemList(juce::StringArray{ "Released first", "Oldest", "Quietest", "Same note" }, 1);
+    addAndMakeVisible(voiceSteal);
+    aVoiceSteal = std::make_unique<ComboBoxAttachment>(apvts, "voiceSteal", voiceSteal);
+    mpeBendRange.setSliderStyle(juce::Slider::LinearHorizontal);
+    mpeBendRange.setTextBoxStyle(juce::Slider::TextBoxRight, false, 40, 18);
+    addAndMakeVisible(mpe);
+    addAndMakeVisible(mpeBendRange);
+    aMpe = std::make_unique<ButtonAttachment>(apvts, "mpe", mpe);
+    aMpeBendRange = std::make_unique<SliderAttachment>(apvts, "mpeBendRange", mpeBendRange);
+
+    auto lfoShapes = juce::StringArray{ "Sine", "Triangle", "Saw", "Square", "Sample & Hold" };
+    lfo1Shape.addItemList(lfoShapes, 1);      addAndMakeVisible(lfo1Shape);
+    lfo2Shape.addItemList(lfoShapes, 1);      addAndMakeVisible(lfo2Shape);
+    modControlRate.addItemList(juce::StringArray{ "8 samples", "16 samples", "32 samples", "64 samples" }, 1);
+    addAndMakeVisible(modControlRate);
+    configKnob(lfo1Rate);   addAndMakeVisible(lfo1Rate);
+    configKnob(lfo2Rate);   addAndMakeVisible(lfo2Rate);
+    configKnob(modAttack);  addAndMakeVisible(modAttack);
+    configKnob(modHold);    addAndMakeVisible(modHold);
+    configKnob(modDecay);   addAndMakeVisible(modDecay);
+    configKnob(modSustain); addAndMakeVisible(modSustain);
+    configKnob(modRelease); addAndMakeVisible(modRelease);
+    voiceSpread.setSliderStyle(juce::Slider::LinearHorizontal);
+    voiceSpread.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    addAndMakeVisible(voiceSpread);
+
+    aLfo1Shape = std::make_unique<ComboBoxAttachment>(apvts, "lfo1Shape", lfo1Shape);
+    aLfo2Shape = std::make_unique<ComboBoxAttachment>(apvts, "lfo2Shape", lfo2Shape);
+    aModControlRate = std::make_unique<ComboBoxAttachment>(apvts, "modControlRate", modControlRate);
+    aLfo1Rate = std::make_unique<SliderAttachment>(apvts, "lfo1Rate", lfo1Rate);
+    aLfo2Rate = std::make_unique<SliderAttachment>(apvts, "lfo2Rate", lfo2Rate);
+    aModAttack = std::make_unique<SliderAttachment>(apvts, "modAttack", modAttack);
+    aModHold = std::make_unique<SliderAttachment>(apvts, "modHold", modHold);
+    aModDecay = std::make_unique<SliderAttachment>(apvts, "modDecay", modDecay);
+    aModSustain = std::make_unique<SliderAttachment>(apvts, "modSustain", modSustain);
+    aModRelease = std::make_unique<SliderAttachment>(apvts, "modRelease", modRelease);
+    aVoiceSpread = std::make_unique<SliderAttachment>(apvts, "voiceSpread", voiceSpread);
+
+    auto modSources = juce::StringArray{ "Off" };
+    modSources.addArray(ModMatrix::getSourceNames());
+    for (size_t i = 0; i < ModMatrix::numSlots; ++i)
+    {
+        const juce::String id = "mod" + juce::String(static_cast<int>(i) + 1);
+        modSource[i].addItemList(modSources, 1);
+        modDest[i].addItemList(ModMatrix::getDestinationNames(), 1);
+        modAmount[i].setSliderStyle(juce::Slider::LinearHorizontal);
+        modAmount[i].setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 18);
+        addAndMakeVisible(modSource[i]);
+        addAndMakeVisible(modDest[i]);
+        addAndMakeVisible(modAmount[i]);
+        aModSource[i] = std::make_unique<ComboBoxAttachment>(apvts, id + "Source", modSource[i]);
+        aModDest[i] = std::make_unique<ComboBoxAttachment>(apvts, id + "Dest", modDest[i]);
+        aModAmount[i] = std::make_unique<SliderAttachment>(apvts, id + "Amount", modAmount[i]);
+    }
+
     osc1Wave.addItemList(juce::StringArray{ "Sine", "Saw", "Square", "Triangle", "Pulse", "Noise" }, 1);
     addAndMakeVisible(osc1Wave);
     configKnob(osc1Level);  addAndMakeVisible(osc1Level);
@@ -46,13 +144,22 @@ CyqnusAudioProcessorEditor::CyqnusAudioProcessorEditor(CyqnusAudioProcessor& p)
     configKnob(osc1Fine);   addAndMakeVisible(osc1Fine);
     configKnob(osc1PW);     addAndMakeVisible(osc1PW);
     configKnob(osc1Detune); addAndMakeVisible(osc1Detune);
+    configKnob(osc1Unison); addAndMakeVisible(osc1Unison);
+    configKnob(osc1Spread); addAndMakeVisible(osc1Spread);
+    configKnob(osc1Blend);  addAndMakeVisible(osc1Blend);
 
     aOsc1Wave = std::make_unique<ComboBoxAttachment>(apvts, "osc1Wave", osc1Wave);
+    osc1Noise.addItemList(juce::StringArray{ "White", "Pink", "Brown" }, 1);
+    addAndMakeVisible(osc1Noise);
+    aOsc1Noise = std::make_unique<ComboBoxAttachment>(apvts, "osc1Noise", osc1Noise);
     aOsc1Level = std::make_unique<SliderAttachment>(apvts, "osc1Level", osc1Level);
     aOsc1Coarse = std::make_unique<SliderAttachment>(apvts, "osc1Coarse", osc1Coarse);
     aOsc1Fine = std::make_unique<SliderAttachment>(apvts, "osc1Fine", osc1Fine);
     aOsc1PW = std::make_unique<SliderAttachment>(apvts, "osc1PW", osc1PW);
     aOsc1Detune = std::make_unique<SliderAttachment>(apvts, "osc1Detune", osc1Detune);
+    aOsc1Unison = std::make_unique<SliderAttachment>(apvts, "osc1Unison", osc1Unison);
+    aOsc1Spread = std::make_unique<SliderAttachment>(apvts, "osc1Spread", osc1Spread);
+    aOsc1Blend = std::make_unique<SliderAttachment>(apvts, "osc1Blend", osc1Blend);
 
     osc2Wave.addItemList(juce::StringArray{ "Sine", "Saw", "Square", "Triangle", "Pulse", "Noise" }, 1);
     addAndMakeVisible(osc2Wave);
@@ -61,13 +168,22 @@ CyqnusAudioProcessorEditor::CyqnusAudioProcessorEditor(CyqnusAudioProcessor& p)
     configKnob(osc2Fine);   addAndMakeVisible(osc2Fine);
     configKnob(osc2PW);     addAndMakeVisible(osc2PW);
     configKnob(osc2Detune); addAndMakeVisible(osc2Detune);
+    configKnob(osc2Unison); addAndMakeVisible(osc2Unison);
+    configKnob(osc2Spread); addAndMakeVisible(osc2Spread);
+    configKnob(osc2Blend);  addAndMakeVisible(osc2Blend);
 
     aOsc2Wave = std::make_unique<ComboBoxAttachment>(apvts, "osc2Wave", osc2Wave);
+    osc2Noise.addItemList(juce::StringArray{ "White", "Pink", "Brown" }, 1);
+    addAndMakeVisible(osc2Noise);
+    aOsc2Noise = std::make_unique<ComboBoxAttachment>(apvts, "osc2Noise", osc2Noise);
     aOsc2Level = std::make_unique<SliderAttachment>(apvts, "osc2Level", osc2Level);
     aOsc2Coarse = std::make_unique<SliderAttachment>(apvts, "osc2Coarse", osc2Coarse);
     aOsc2Fine = std::make_unique<SliderAttachment>(apvts, "osc2Fine", osc2Fine);
     aOsc2PW = std::make_unique<SliderAttachment>(apvts, "osc2PW", osc2PW);
     aOsc2Detune = std::make_unique<SliderAttachment>(apvts, "osc2Detune", osc2Detune);
+    aOsc2Unison = std::make_unique<SliderAttachment>(apvts, "osc2Unison", osc2Unison);
+    aOsc2Spread = std::make_unique<SliderAttachment>(apvts, "osc2Spread", osc2Spread);
+    aOsc2Blend = std::make_unique<SliderAttachment>(apvts, "osc2Blend", osc2Blend);
 
     osc3Wave.addItemList(juce::StringArray{ "Sine", "Saw", "Square", "Triangle", "Pulse", "Noise" }, 1);
     addAndMakeVisible(osc3Wave);
@@ -76,17 +192,72 @@ CyqnusAudioProcessorEditor::CyqnusAudioProcessorEditor(CyqnusAudioProcessor& p)
     configKnob(osc3Fine);   addAndMakeVisible(osc3Fine);
     configKnob(osc3PW);     addAndMakeVisible(osc3PW);
     configKnob(osc3Detune); addAndMakeVisible(osc3Detune);
+    configKnob(osc3Unison); addAndMakeVisible(osc3Unison);
+    configKnob(osc3Spread); addAndMakeVisible(osc3Spread);
+    configKnob(osc3Blend);  addAndMakeVisible(osc3Blend);
 
     aOsc3Wave = std::make_unique<ComboBoxAttachment>(apvts, "osc3Wave", osc3Wave);
+    osc3Noise.addItemList(juce::StringArray{ "White", "Pink", "Brown" }, 1);
+    addAndMakeVisible(osc3Noise);
+    aOsc3Noise = std::make_unique<ComboBoxAttachment>(apvts, "osc3Noise", osc3Noise);
     aOsc3Level = std::make_unique<SliderAttachment>(apvts, "osc3Level", osc3Level);
     aOsc3Coarse = std::make_unique<SliderAttachment>(apvts, "osc3Coarse", osc3Coarse);
     aOsc3Fine = std::make_unique<SliderAttachment>(apvts, "osc3Fine", osc3Fine);
     aOsc3PW = std::make_unique<SliderAttachment>(apvts, "osc3PW", osc3PW);
     aOsc3Detune = std::make_unique<SliderAttachment>(apvts, "osc3Detune", osc3Detune);
+
+    aOsc3Unison = std::make_unique<SliderAttachment>(apvts, "osc3Unison", osc3Unison);
+    aOsc3Spread = std::make_unique<SliderAttachment>(apvts, "osc3Spread", osc3Spread);
+    aOsc3Blend = std::make_unique<SliderAttachment>(apvts, "osc3Blend", osc3Blend);
+
+    addAndMakeVisible(resetLoadStats);
+    resetLoadStats.onClick = [this]
+        {
+            audioProcessor.blockLoad.reset();
+            audioProcessor.voiceLoad.reset();
+        };
+
+    startTimerHz(30);
 }
 
 CyqnusAudioProcessorEditor::~CyqnusAudioProcessorEditor()
 {
+    stopTimer();
+}
+
+void CyqnusAudioProcessorEditor::timerCallback()
+{
+    TelemetryFrame frame;
+    bool received = false;
+    displayPeak = {};
+    displayRms = {};
+    displayLoad = 0.0;
+
+    while (audioProcessor.telemetry.pop(frame))
+    {
+        received = true;
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            displayPeak[ch] = juce::jmax(displayPeak[ch], frame.peak[ch]);
+            displayRms[ch] = juce::jmax(displayRms[ch], frame.rms[ch]);
+        }
+        if (frame.blockSeconds > 0.0)
+            displayLoad = juce::jmax(displayLoad, frame.processSeconds / frame.blockSeconds);
+        latestFrame = frame;
+    }
+
+    // Spikes are held for about two seconds so a single slow block stays readable.
+    if (displayLoad >= peakLoad || ++ticksSincePeakLoad > 60)
+    {
+        peakLoad = displayLoad;
+        ticksSincePeakLoad = 0;
+    }
+
+    blockStats = audioProcessor.blockLoad.getStats();
+    voiceStats = audioProcessor.voiceLoad.getStats();
+
+    if (received)
+        repaint(0, monitorY, getWidth(), getHeight() - monitorY);
 }
 
 //==============================================================================
@@ -104,6 +275,7 @@ void CyqnusAudioProcessorEditor::paint(juce::Graphics& g)
     g.drawFittedText("Oscillator 1", { 10, 165, 200, 20 }, juce::Justification::left, 1);
     g.drawFittedText("Oscillator 2", { 10, 285, 200, 20 }, juce::Justification::left, 1);
     g.drawFittedText("Oscillator 3", { 10, 405, 200, 20 }, juce::Justification::left, 1);
+    g.drawFittedText("FILTER", { 10, 505, 200, 20 }, juce::Justification::left, 1);
 
     g.setFont(13.0f);
     g.setColour(juce::Colours::grey);
@@ -114,6 +286,8 @@ void CyqnusAudioProcessorEditor::paint(juce::Graphics& g)
     g.drawFittedText("Sustain", { 340,  95, 100, 20 }, juce::Justification::centredTop, 1);
     g.drawFittedText("Release", { 450,  95, 100, 20 }, juce::Justification::centredTop, 1);
     g.drawFittedText("Gain", { 560,  95, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Osc Quality", { 620,  37, 110, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Amp Curve", { 620,  95, 110, 20 }, juce::Justification::centredTop, 1);
     // === Oscillator column headers (applies to all 3 rows) ===
     g.drawFittedText("Waveform", { 10, 200, 100, 20 }, juce::Justification::centredTop, 1);
     g.drawFittedText("Level", { 120, 200, 100, 20 }, juce::Justification::centredTop, 1);
@@ -121,17 +295,137 @@ void CyqnusAudioProcessorEditor::paint(juce::Graphics& g)
     g.drawFittedText("Fine", { 340, 200, 100, 20 }, juce::Justification::centredTop, 1);
     g.drawFittedText("Pulse W.", { 450, 200, 100, 20 }, juce::Justification::centredTop, 1);
     g.drawFittedText("Detune", { 560, 200, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Unison", { 670, 200, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Spread", { 780, 200, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Blend", { 890, 200, 100, 20 }, juce::Justification::centredTop, 1);
+    // === Filter labels ===
+    g.drawFittedText("Type", { 10, 556, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Mod Rate", { 10, 606, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Cutoff", { 120, 615, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Resonance", { 230, 615, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Env Amount", { 340, 615, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Attack", { 450, 615, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Hold", { 560, 615, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Decay", { 670, 615, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Sustain", { 780, 615, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Release", { 890, 615, 100, 20 }, juce::Justification::centredTop, 1);
 
     // draw dividing lines for clarity
     g.setColour(juce::Colours::darkgrey);
-    g.drawLine(0.0f, 135.0f, (float)getWidth(), 135.0f, 1.0f); // line under env
-    g.drawLine(0.0f, 260.0f, (float)getWidth(), 260.0f, 0.5f); // line under osc1
-    g.drawLine(0.0f, 380.0f, (float)getWidth(), 380.0f, 0.5f); // line under osc2
+    g.drawLine(0.0f, 135.0f, (float)modulationX, 135.0f, 1.0f); // line under env
+    g.drawLine(0.0f, 260.0f, (float)modulationX, 260.0f, 0.5f); // line under osc1
+    g.drawLine(0.0f, 380.0f, (float)modulationX, 380.0f, 0.5f); // line under osc2
+    g.drawLine(0.0f, 500.0f, (float)modulationX, 500.0f, 1.0f); // line under oscillators
 
     // Add a section header for the keyboard
     g.setFont(15.0f);
     g.setColour(juce::Colours::white);
-    g.drawFittedText("KEYBOARD", { 10, 525, 200, 20 }, juce::Justification::left, 1);
+    g.drawFittedText("KEYBOARD", { 10, 645, 200, 20 }, juce::Justification::left, 1);
+    g.drawFittedText("ENGINE", { 10, 765, 200, 20 }, juce::Justification::left, 1);
+
+    g.setFont(13.0f);
+    g.setColour(juce::Colours::grey);
+    g.drawFittedText("Polyphony", { 10, 790, 100, 24 }, juce::Justification::centredLeft, 1);
+    g.drawFittedText("Oversampling", { 670, 790, 100, 24 }, juce::Justification::centredLeft, 1);
+    g.drawFittedText("Voice steal", { 10, 820, 100, 24 }, juce::Justification::centredLeft, 1);
+    g.drawFittedText("MPE bend", { 670, 820, 100, 24 }, juce::Justification::centredLeft, 1);
+
+    // === Modulation ===
+    const int modX = modulationX + 10;
+    g.setColour(juce::Colours::darkgrey);
+    g.drawLine((float)modulationX, 0.0f, (float)modulationX, (float)getHeight(), 1.0f);
+    g.drawLine((float)modulationX, 135.0f, (float)getWidth(), 135.0f, 1.0f); // line under the LFOs
+    g.drawLine((float)modulationX, 270.0f, (float)getWidth(), 270.0f, 1.0f); // line under the mod envelope
+    g.setFont(15.0f);
+    g.setColour(juce::Colours::white);
+    g.drawFittedText("MODULATION", { modX, 5, 200, 20 }, juce::Justification::left, 1);
+    g.drawFittedText("Mod Envelope", { modX, 140, 200, 20 }, juce::Justification::left, 1);
+    g.drawFittedText("Routing", { modX, 275, 200, 20 }, juce::Justification::left, 1);
+
+    g.setFont(13.0f);
+    g.setColour(juce::Colours::grey);
+    g.drawFittedText("LFO 1", { modX, 56, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Control Rate", { modX, 106, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Rate", { modX + 110, 115, 90, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("LFO 2", { modX + 220, 56, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Voice Spread", { modX + 220, 106, 100, 20 }, juce::Justification::centredTop, 1);
+    g.drawFittedText("Rate", { modX + 330, 115, 90, 20 }, juce::Justification::centredTop, 1);
+
+    int labelX = modX;
+    for (const auto* name : { "Attack", "Hold", "Decay", "Sustain", "Release" })
+    {
+        g.drawFittedText(name, { labelX, 245, 90, 20 }, juce::Justification::centredTop, 1);
+        labelX += 95;
+    }
+
+    paintMonitor(g);
+}
+
+void CyqnusAudioProcessorEditor::paintMonitor(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::darkgrey);
+    g.drawLine(0.0f, (float)monitorY, (float)modulationX, (float)monitorY, 1.0f);
+
+    g.setFont(15.0f);
+    g.setColour(juce::Colours::white);
+    g.drawFittedText("MONITOR", { 10, monitorY + 5, 200, 20 }, juce::Justification::left, 1);
+
+    // Peak bars with the RMS level drawn over them, -60..0 dB.
+    g.setFont(13.0f);
+    const juce::String channelNames[] = { "L", "R" };
+    for (size_t ch = 0; ch < 2; ++ch)
+    {
+        const int y = monitorY + 35 + static_cast<int>(ch) * 20;
+        const juce::Rectangle<int> bar{ 30, y, 280, 12 };
+        auto toWidth = [&](float gain)
+            {
+                const float db = juce::Decibels::gainToDecibels(gain, -60.0f);
+                return juce::roundToInt(juce::jmap(db, -60.0f, 0.0f, 0.0f, (float)bar.getWidth()));
+            };
+
+        g.setColour(juce::Colours::grey);
+        g.drawFittedText(channelNames[ch], { 10, y - 2, 15, 16 }, juce::Justification::centredLeft, 1);
+        g.setColour(juce::Colour(0xff202020));
+        g.fillRect(bar);
+        g.setColour(displayPeak[ch] >= 1.0f ? juce::Colours::red : juce::Colours::limegreen);
+        g.fillRect(bar.withWidth(toWidth(displayPeak[ch])));
+        g.setColour(juce::Colours::darkgreen);
+        g.fillRect(bar.withWidth(toWidth(displayRms[ch])).reduced(0, 3));
+    }
+
+    g.setColour(juce::Colours::grey);
+    g.drawFittedText("CPU " + juce::String(displayLoad * 100.0, 1) + "%  (peak " + juce::String(peakLoad * 100.0, 1) + "%)",
+        { 330, monitorY + 30, 300, 20 }, juce::Justification::centredLeft, 1);
+    g.drawFittedText("Voices " + juce::String(latestFrame.numActiveVoices) + " / " + juce::String(latestFrame.polyphony)
+        + "   stolen " + juce::String(latestFrame.numStolenVoices)
+        + "   merged frames " + juce::String(audioProcessor.telemetry.getNumMerged()),
+        { 330, monitorY + 52, 320, 20 }, juce::Justification::centredLeft, 1);
+
+    auto describeLoad = [](const juce::String& name, const LoadHistogram::Stats& stats)
+        {
+            return name + " p50 " + juce::String(stats.p50 * 100.0, 1) + "%  p99 " + juce::String(stats.p99 * 100.0, 1)
+                + "%  max " + juce::String(stats.max * 100.0, 1) + "%  over " + juce::String(juce::roundToInt(LoadHistogram::xrunRiskLoad * 100.0))
+                + "%: " + juce::String(stats.xrunRiskBlocks) + " / " + juce::String(stats.count);
+        };
+    g.drawFittedText(describeLoad("Block", blockStats), { 10, monitorY + 74, 320, 20 }, juce::Justification::centredLeft, 1);
+    g.drawFittedText(describeLoad("Voice", voiceStats), { 330, monitorY + 74, 320, 20 }, juce::Justification::centredLeft, 1);
+
+    // One cell per voice within the polyphony limit, coloured by amp envelope stage.
+    const juce::Colour stageColours[] = {
+        juce::Colour(0xff303030),   // Idle
+        juce::Colours::orange,      // Attack
+        juce::Colours::yellow,      // Hold
+        juce::Colours::greenyellow, // Decay
+        juce::Colours::limegreen,   // Sustain
+        juce::Colours::dodgerblue   // Release
+    };
+    const int numCells = juce::jmin(latestFrame.polyphony, maxDisplayedVoices);
+    for (int i = 0; i < numCells; ++i)
+    {
+        const auto state = static_cast<size_t>(latestFrame.voiceState[static_cast<size_t>(i)]);
+        g.setColour(stageColours[state]);
+        g.fillRect(660 + (i % 32) * 10, monitorY + 35 + (i / 32) * 12, 8, 8);
+    }
 }
 
 void CyqnusAudioProcessorEditor::resized()
@@ -148,24 +442,74 @@ void CyqnusAudioProcessorEditor::resized()
     x += 100;
     release.setBounds(x, envRow.getY(), knobW, knobH); x += 100;
 
-    masterGain.setBounds(x, envRow.getY(), knobW, knobH);
+    masterGain.setBounds(x, envRow.getY(), knobW, knobH); x += 110;
+    oscQuality.setBounds(x, envRow.getY(), 110, 24);
+    ampCurve.setBounds(x, envRow.getY() + 58, 110, 24);
 
     area.removeFromTop(20);
-    auto placeOscRow = [&](auto& wave, auto& level, auto& coarse, auto& fine, auto& pw, auto& detune, int rowY)
+    auto placeOscRow = [&](auto& wave, auto& noise, auto& level, auto& coarse, auto& fine, auto& pw, auto& detune,
+        auto& unison, auto& spread, auto& blend, int rowY)
         {
             wave.setBounds(10, rowY, 100, 24);
+            noise.setBounds(10, rowY + 30, 100, 24);
             level.setBounds(120, rowY, knobW, knobH);
             coarse.setBounds(230, rowY, knobW, knobH);
             fine.setBounds(340, rowY, knobW, knobH);
             pw.setBounds(450, rowY, knobW, knobH);
             detune.setBounds(560, rowY, knobW, knobH);
+            unison.setBounds(670, rowY, knobW, knobH);
+            spread.setBounds(780, rowY, knobW, knobH);
+            blend.setBounds(890, rowY, knobW, knobH);
         };
 
     int oscRowHeight = 120;
-    placeOscRow(osc1Wave, osc1Level, osc1Coarse, osc1Fine, osc1PW, osc1Detune, area.removeFromTop(oscRowHeight).getY());
-    placeOscRow(osc2Wave, osc2Level, osc2Coarse, osc2Fine, osc2PW, osc2Detune, area.removeFromTop(oscRowHeight).getY());
-    placeOscRow(osc3Wave, osc3Level, osc3Coarse, osc3Fine, osc3PW, osc3Detune, area.removeFromTop(oscRowHeight).getY());
+    placeOscRow(osc1Wave, osc1Noise, osc1Level, osc1Coarse, osc1Fine, osc1PW, osc1Detune, osc1Unison, osc1Spread, osc1Blend, area.removeFromTop(oscRowHeight).getY());
+    placeOscRow(osc2Wave, osc2Noise, osc2Level, osc2Coarse, osc2Fine, osc2PW, osc2Detune, osc2Unison, osc2Spread, osc2Blend, area.removeFromTop(oscRowHeight).getY());
+    placeOscRow(osc3Wave, osc3Noise, osc3Level, osc3Coarse, osc3Fine, osc3PW, osc3Detune, osc3Unison, osc3Spread, osc3Blend, area.removeFromTop(oscRowHeight).getY());
+
+    const int filterY = 530;
+    filterType.setBounds(10, filterY, 100, 24);
+    filterModRate.setBounds(10, filterY + 50, 100, 24);
+    x = 120;
+    for (auto* knob : { &filterCutoff, &filterResonance, &filterEnvAmount, &filterAttack,
+                        &filterHold, &filterDecay, &filterSustain, &filterRelease })
+    {
+        knob->setBounds(x, filterY, knobW, knobH);
+        x += 110;
+    }
 
     // Position the keyboard at the bottom
-    keyboardComponent.setBounds(10, 550, getWidth() - 20, 100);
+    keyboardComponent.setBounds(10, 670, modulationX - 20, 80);
+
+    polyphony.setBounds(110, 790, 300, 24);
+    parallelVoices.setBounds(430, 790, 220, 24);
+    voiceBank.setBounds(430, 820, 220, 24);
+    oversampling.setBounds(780, 790, 100, 24);
+    voiceSteal.setBounds(110, 820, 150, 24);
+    mpe.setBounds(270, 820, 150, 24);
+    mpeBendRange.setBounds(780, 820, 200, 24);
+
+    // Sources, then the mod envelope, then the slots, down the modulation column.
+    const int modX = modulationX + 10;
+    lfo1Shape.setBounds(modX, 30, 100, 24);
+    modControlRate.setBounds(modX, 80, 100, 24);
+    lfo1Rate.setBounds(modX + 110, 30, knobW, knobH);
+    lfo2Shape.setBounds(modX + 220, 30, 100, 24);
+    lfo2Rate.setBounds(modX + 330, 30, knobW, knobH);
+    voiceSpread.setBounds(modX + 220, 80, 100, 24);
+    x = modX;
+    for (auto* knob : { &modAttack, &modHold, &modDecay, &modSustain, &modRelease })
+    {
+        knob->setBounds(x, 160, knobW, knobH);
+        x += 95;
+    }
+
+    for (size_t i = 0; i < ModMatrix::numSlots; ++i)
+    {
+        const int slotY = 300 + static_cast<int>(i) * 28;
+        modSource[i].setBounds(modX, slotY, 120, 24);
+        modDest[i].setBounds(modX + 125, slotY, 150, 24);
+        modAmount[i].setBounds(modX + 280, slotY, 200, 24);
+    }
+    resetLoadStats.setBounds(660, monitorY + 66, 120, 22);
 }
\ No newline at end of file
@@ -6,7 +6,8 @@
 //==============================================================================
 /**
 */
-class CyqnusAudioProcessorEditor : public juce::AudioProcessorEditor
+class CyqnusAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                   private juce::Timer
 {
 public:
     explicit CyqnusAudioProcessorEditor(CyqnusAudioProcessor&);
@@ -17,26 +18,82 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+    void paintMonitor(juce::Graphics& g);
+
     CyqnusAudioProcessor& audioProcessor;
 
+    // Engine telemetry drained on the timer; levels and load are the maxima since the last tick.
+    // The modulation section is a column right of the main controls, so the editor stays
+    // short enough for a 1080p screen.
+    static constexpr int modulationX = 1000;
+    static constexpr int monitorY = 860;
+    static constexpr int maxDisplayedVoices = 64;
+    TelemetryFrame latestFrame;
+    std::array<float, 2> displayPeak{};
+    std::array<float, 2> displayRms{};
+    double displayLoad = 0.0;
+    double peakLoad = 0.0;
+    int ticksSincePeakLoad = 0;
+    LoadHistogram::Stats blockStats, voiceStats;
+    juce::TextButton resetLoadStats{ "Reset load stats" };
+
     juce::MidiKeyboardState keyboardState;
     juce::MidiKeyboardComponent keyboardComponent;
 
     using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
     using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
+    using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
 
     juce::Slider attack, hold, decay, sustain, release, masterGain;
     std::unique_ptr<SliderAttachment> aAttack, aHold, aDecay, aSustain, aRelease, aGain;
 
+    juce::ComboBox oscQuality, ampCurve;
+    std::unique_ptr<ComboBoxAttachment> aOscQuality, aAmpCurve;
+
+    juce::ComboBox filterType, filterModRate;
+    juce::Slider filterCutoff, filterResonance, filterEnvAmount,
+        filterAttack, filterHold, filterDecay, filterSustain, filterRelease;
+    std::unique_ptr<ComboBoxAttachment> aFilterType, aFilterModRate;
+    std::unique_ptr<SliderAttachment> aFilterCutoff, aFilterResonance, aFilterEnvAmount,
+        aFilterAttack, aFilterHold, aFilterDecay, aFilterSustain, aFilterRelease;
+
+    juce::Slider polyphony;
+    juce::ToggleButton parallelVoices{ "Parallel voice rendering" };
+    juce::ToggleButton voiceBank{ "Voice bank engine (SIMD)" };
+    std::unique_ptr<SliderAttachment> aPolyphony;
+    std::unique_ptr<ButtonAttachment> aParallelVoices, aVoiceBank;
+    juce::ComboBox oversampling;
+    std::unique_ptr<ComboBoxAttachment> aOversampling;
+    juce::ComboBox voiceSteal;
+    std::unique_ptr<ComboBoxAttachment> aVoiceSteal;
+    juce::ToggleButton mpe{ "MPE (lower zone)" };
+    juce::Slider mpeBendRange;
+    std::unique_ptr<ButtonAttachment> aMpe;
+    std::unique_ptr<SliderAttachment> aMpeBendRange;
+
+    juce::ComboBox lfo1Shape, lfo2Shape, modControlRate;
+    juce::Slider lfo1Rate, lfo2Rate, modAttack, modHold, modDecay, modSustain, modRelease, voiceSpread;
+    std::unique_ptr<ComboBoxAttachment> aLfo1Shape, aLfo2Shape, aModControlRate;
+    std::unique_ptr<SliderAttachment> aLfo1Rate, aLfo2Rate, aModAttack, aModHold, aModDecay, aModSustain, aModRelease, aVoiceSpread;
+
+    // One row per mod matrix slot: source, destination, amount.
+    std::array<juce::ComboBox, ModMatrix::numSlots> modSource, modDest;
+    std::array<juce::Slider, ModMatrix::numSlots> modAmount;
+    std::array<std::unique_ptr<ComboBoxAttachment>, ModMatrix::numSlots> aModSource, aModDest;
+    std::array<std::unique_ptr<SliderAttachment>, ModMatrix::numSlots> aModAmount;
+
     juce::ComboBox osc1Wave, osc2Wave, osc3Wave;
-    juce::Slider osc1Level, osc1Coarse, osc1Fine, osc1PW, osc1Detune,
-        osc2Level, osc2Coarse, osc2Fine, osc2PW, osc2Detune,
-        osc3Level, osc3Coarse, osc3Fine, osc3PW, osc3Detune;
+    juce::ComboBox osc1Noise, osc2Noise, osc3Noise; // colour when the waveform is Noise
+    juce::Slider osc1Level, osc1Coarse, osc1Fine, osc1PW, osc1Detune, osc1Unison, osc1Spread, osc1Blend,
+        osc2Level, osc2Coarse, osc2Fine, osc2PW, osc2Detune, osc2Unison, osc2Spread, osc2Blend,
+        osc3Level, osc3Coarse, osc3Fine, osc3PW, osc3Detune, osc3Unison, osc3Spread, osc3Blend;
 
     std::unique_ptr<ComboBoxAttachment> aOsc1Wave, aOsc2Wave, aOsc3Wave;
-    std::unique_ptr<SliderAttachment> aOsc1Level, aOsc1Coarse, aOsc1Fine, aOsc1PW, aOsc1Detune,
-        aOsc2Level, aOsc2Coarse, aOsc2Fine, aOsc2PW, aOsc2Detune,
-        aOsc3Level, aOsc3Coarse, aOsc3Fine, aOsc3PW, aOsc3Detune;
+    std::unique_ptr<ComboBoxAttachment> aOsc1Noise, aOsc2Noise, aOsc3Noise;
+    std::unique_ptr<SliderAttachment> aOsc1Level, aOsc1Coarse, aOsc1Fine, aOsc1PW, aOsc1Detune, aOsc1Unison, aOsc1Spread, aOsc1Blend,
+        aOsc2Level, aOsc2Coarse, aOsc2Fine, aOsc2PW, aOsc2Detune, aOsc2Unison, aOsc2Spread, aOsc2Blend,
+        aOsc3Level, aOsc3Coarse, aOsc3Fine, aOsc3PW, aOsc3Detune, aOsc3Unison, aOsc3Spread, aOsc3Blend;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CyqnusAudioProcessorEditor)
 };
@@ -8,9 +8,10 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeCheck.h"
 
 //==============================================================================
-CyqnusAudioProcessor::CyqnusAudioProcessor()
+CyqnusAudioProcessor::CyqnusAudioProcessor(bool forOfflineRendering)
 #ifndef JucePlugin_PreferredChannelConfigurations
     : AudioProcessor(BusesProperties()
 #if ! JucePlugin_IsMidiEffect
@@ -23,14 +24,29 @@ CyqnusAudioProcessor::CyqnusAudioProcessor()
     apvts(*this, nullptr, "PARAMS", createParameterLayout())
 #endif
 {
-    for (int i = 0; i < kNumVoice; ++i) {
-        synth.addVoice(new SynthVoice(apvts));
+    static_assert(CyqnusSynthesiser::maxVoices <= VoiceBank::maxVoices, "every voice needs a bank slot");
+    static_assert(CyqnusSynthesiser::maxVoices <= TelemetryFrame::maxVoices, "every voice needs a telemetry entry");
+
+    for (int i = 0; i < CyqnusSynthesiser::maxVoices; ++i) {
+        auto* voice = new SynthVoice(params, wavetables, voiceBank, i);
+        voice->setLoadHistogram(&voiceLoad);
+        voice->setChannelStates(synth.getChannelStates());
+        synth.addVoice(voice);
     }
     synth.addSound(new SynthSound());
+    synth.setVoiceBank(&voiceBank);
+
+    offlineRenderer = forOfflineRendering;
+    if (!offlineRenderer)
+    {
+        presetBank.open(getDefaultPresetBankFile());
+        apvts.addParameterListener("parallelVoices", this);
+    }
 }
 
 CyqnusAudioProcessor::~CyqnusAudioProcessor()
 {
+    apvts.removeParameterListener("parallelVoices", this);
 }
 
 //==============================================================================
@@ -68,42 +84,219 @@ bool CyqnusAudioProcessor::isMidiEffect() const
 
 double CyqnusAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // Lets hosts stop processing once the release of the last note has run out.
+    return apvts.getRawParameterValue("ampRelease")->load();
 }
 
 int CyqnusAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-    // so this should be at least 1, even if you're not really implementing programs.
+    // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    // so this should be at least 1, even without a preset bank.
+    return juce::jmax(1, presetBank.getNumPresets());
 }
 
 int CyqnusAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void CyqnusAudioProcessor::setCurrentProgram(int index)
 {
+    if (!juce::isPositiveAndBelow(index, presetBank.getNumPresets()))
+        return;
+
+    beginParameterSwap();
+    presetBank.apply(index);
+    finishParameterSwap();
+    currentProgram = index;
 }
 
 const juce::String CyqnusAudioProcessor::getProgramName(int index)
 {
-    return {};
+    return presetBank.getName(index);
 }
 
-void CyqnusAudioProcessor::changeProgramName(int index, const juce::String& newName)
+void CyqnusAudioProcessor::changeProgramName(int, const juce::String&)
 {
+    // The bank is mapped read-only; rebuild it with writePresetBank to rename presets.
+}
+
+juce::Result CyqnusAudioProcessor::loadStateFile(const juce::File& file)
+{
+    juce::MemoryBlock state;
+    if (!file.loadFileAsData(state))
+        return juce::Result::fail("Could not read " + file.getFullPathName());
+
+    if (PresetFormat::isBinaryState(state.getData(), state.getSize()))
+    {
+        setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+        return juce::Result::ok();
+    }
+
+    auto xml = getXmlFromBinary(state.getData(), static_cast<int>(state.getSize()));
+    if (xml == nullptr)
+        xml = juce::parseXML(state.toString());
+    if (xml == nullptr)
+        return juce::Result::fail("Could not parse preset " + file.getFullPathName());
+
+    beginParameterSwap();
+    apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    finishParameterSwap();
+    return juce::Result::ok();
+}
+
+void CyqnusAudioProcessor::beginParameterSwap()
+{
+    // Waits out the audio thread while it copies the previous pending set (a plain struct copy).
+    for (;;)
+    {
+        auto expected = parameterSwap.load(std::memory_order_acquire);
+        if (expected != ParameterSwap::Swapping
+            && parameterSwap.compare_exchange_weak(expected, ParameterSwap::Preparing, std::memory_order_acquire))
+            return;
+        juce::Thread::yield();
+    }
+}
+
+void CyqnusAudioProcessor::finishParameterSwap()
+{
+    parameterCache.fill(pendingParams);
+    parameterSwap.store(ParameterSwap::Ready, std::memory_order_release);
+}
+
+void CyqnusAudioProcessor::updateParameterSwap()
+{
+    if (parameterSwap.load(std::memory_order_acquire) == ParameterSwap::Idle)
+    {
+        parameterCache.fill(params);
+        return;
+    }
+
+    // The parameters are changing underneath: keep the current snapshot until the new one can
+    // go in without a click.
+    const bool fadedOut = programFadingOut && !programFade.isSmoothing();
+    if (!fadedOut && !synth.isSilent())
+    {
+        if (!programFadingOut && parameterSwap.load(std::memory_order_acquire) == ParameterSwap::Ready)
+        {
+            programFadingOut = true;
+            programFade.setTargetValue(0.0f);
+        }
+        return;
+    }
+
+    auto expected = ParameterSwap::Ready;
+    if (!parameterSwap.compare_exchange_strong(expected, ParameterSwap::Swapping, std::memory_order_acquire))
+        return; // still being prepared, stay where we are
+
+    params = pendingParams;
+    parameterSwap.store(ParameterSwap::Idle, std::memory_order_release);
+
+    if (programFadingOut)
+    {
+        programFadingOut = false;
+        programFade.setTargetValue(1.0f);
+    }
+}
+
+void CyqnusAudioProcessor::parameterChanged(const juce::String&, float newValue)
+{
+    // Can come from the audio thread during automation, so the workers are started later.
+    if (newValue >= 0.5f)
+        triggerAsyncUpdate();
+}
+
+void CyqnusAudioProcessor::handleAsyncUpdate()
+{
+    if (apvts.getRawParameterValue("parallelVoices")->load() >= 0.5f)
+        synth.prepareRenderPool();
+
+    // The audio thread switches the oversampling order; the host hears about the new latency here.
+    const int latency = oversamplingLatency.load(std::memory_order_relaxed);
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+
+    const int program = requestedProgram.exchange(-1);
+    if (program >= 0)
+        setCurrentProgram(program);
+    if (program >= 0 || programChangedOffline.exchange(false))
+        updateHostDisplay();
+}
+
+juce::File CyqnusAudioProcessor::getDefaultPresetBankFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("Cyqnus").getChildFile("Presets.cyqbank");
+}
+
+bool CyqnusAudioProcessor::loadPresetBank(const juce::File& file)
+{
+    currentProgram = 0;
+    const bool opened = presetBank.open(file);
+    updateHostDisplay();
+    return opened;
+}
+
+juce::Result CyqnusAudioProcessor::writePresetBank(const juce::File& bankFile, const juce::Array<juce::File>& stateFiles)
+{
+    // Each state is loaded into this processor to read its normalised values, then the
+    // current state is put back.
+    juce::MemoryBlock currentState;
+    getStateInformation(currentState);
+
+    juce::StringArray names;
+    std::vector<std::vector<float>> values;
+    auto result = juce::Result::ok();
+
+    for (const auto& file : stateFiles)
+    {
+        if ((result = loadStateFile(file)).failed())
+            break;
+
+        names.add(file.getFileNameWithoutExtension());
+        auto& record = values.emplace_back();
+        for (int p = 0; p < presetFormat.getNumParameters(); ++p)
+            record.push_back(presetFormat.getParameter(p)->getValue());
+    }
+
+    setStateInformation(currentState.getData(), static_cast<int>(currentState.getSize()));
+    if (result.failed())
+        return result;
+    return PresetBank::write(bankFile, presetFormat, names, values);
 }
 
 //==============================================================================
 void CyqnusAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    juce::ignoreUnused(samplesPerBlock);
-    synth.setCurrentPlaybackSampleRate(sampleRate);
+    wavetables.build();
+    hostSampleRate = sampleRate;
+    hostBlockSize = samplesPerBlock;
+
+    // The voice bus and render pool are sized for the highest oversampling factor.
+    const auto numChannels = static_cast<size_t>(getTotalNumOutputChannels());
+    synth.prepare(sampleRate, samplesPerBlock << maxOversamplingOrder);
+
+    for (size_t i = 0; i < oversamplers.size(); ++i)
+    {
+        // Integer latency so it can be reported to the host exactly.
+        oversamplers[i] = std::make_unique<juce::dsp::Oversampling<float>>(numChannels, i + 1,
+            juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true, true);
+        oversamplers[i]->initProcessing(static_cast<size_t>(samplesPerBlock));
+    }
 
-    for (int i = 0; i < synth.getNumVoices(); ++i)
-        if (auto* voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
-            voice->prepareToPlay(sampleRate, samplesPerBlock);
+    if (!offlineRenderer && apvts.getRawParameterValue("parallelVoices")->load() >= 0.5f)
+        synth.prepareRenderPool();
+
+    oversamplingOrder = -1;
+    setOversamplingOrder(static_cast<int>(apvts.getRawParameterValue("oversampling")->load()));
+    setLatencySamples(oversamplingLatency.load(std::memory_order_relaxed));
+
+    // Nothing is playing yet, so a program or state loaded before now needs no fade.
+    if (parameterSwap.load(std::memory_order_acquire) == ParameterSwap::Ready)
+        parameterSwap.store(ParameterSwap::Idle, std::memory_order_release);
+    programFade.reset(sampleRate, programFadeSeconds);
+    programFade.setCurrentAndTargetValue(1.0f);
+    programFadingOut = false;
 
     procSpec.sampleRate = sampleRate;
     procSpec.maximumBlockSize = samplesPerBlock;
@@ -111,12 +304,46 @@ void CyqnusAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 
     masterGain.prepare(procSpec);
     masterGain.setRampDurationSeconds(0.05);
+
+    keyboardMidi.ensureSize(MidiEventQueue::capacity * 4);
+    midiQueue.clear();
+}
+
+bool CyqnusAudioProcessor::setOversamplingOrder(int order)
+{
+    order = juce::jlimit(0, maxOversamplingOrder, order);
+    if (order == oversamplingOrder)
+        return false;
+    oversamplingOrder = order;
+
+    // Only sample rates change here, nothing is allocated, so this is safe from processBlock.
+    // Like any rate change it cuts the notes that are sounding.
+    const double renderRate = hostSampleRate * (1 << order);
+    synth.setCurrentPlaybackSampleRate(renderRate);
+    voiceBank.prepare(renderRate);
+
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+        if (auto* voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
+            voice->prepareToPlay(renderRate, hostBlockSize);
+
+    // The latency is only stored: reporting it to the host is left to the message thread.
+    auto* oversampler = getOversampler();
+    if (oversampler != nullptr)
+        oversampler->reset();
+    oversamplingLatency.store(oversampler != nullptr ? juce::roundToInt(oversampler->getLatencyInSamples()) : 0,
+        std::memory_order_relaxed);
+    return true;
+}
+
+juce::dsp::Oversampling<float>* CyqnusAudioProcessor::getOversampler() const
+{
+    return oversamplingOrder > 0 ? oversamplers[static_cast<size_t>(oversamplingOrder - 1)].get() : nullptr;
 }
 
 void CyqnusAudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    // The realtime workers aren't left waiting while nothing is played.
+    synth.releaseRenderPool();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -148,20 +375,163 @@ bool CyqnusAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) co
 void CyqnusAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    const RealtimeCheck::Scope realtimeCheck;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
     buffer.clear();
 
-    juce::MidiBuffer keyboardMidiMessages;
-    keyboardState.processNextMidiBuffer(keyboardMidiMessages, 0, buffer.getNumSamples(), true);
-
-    midiMessages.addEvents(keyboardMidiMessages, 0, buffer.getNumSamples(), 0);
+    keyboardMidi.clear();
+    keyboardState.processNextMidiBuffer(keyboardMidi, 0, buffer.getNumSamples(), true);
+
+    midiQueue.clear();
+    midiQueue.addEvents(midiMessages);
+    midiQueue.addEvents(keyboardMidi);
+
+    // The last Program Change in the block wins. Offline there is no message loop to wait
+    // for, so the preset's parameters are swapped in right here; only telling the host is
+    // left to the message thread.
+    int program = -1;
+    for (const auto& event : midiQueue)
+        if ((event.data[0] & 0xf0) == 0xc0 && event.numBytes == 2)
+            program = event.data[1];
+    if (program >= 0)
+    {
+        if (isNonRealtime())
+        {
+            setCurrentProgram(program);
+            programChangedOffline.store(true);
+        }
+        else
+        {
+            requestedProgram.store(program);
+        }
+        triggerAsyncUpdate();
+    }
 
-    synth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+    updateParameterSwap();
+    synth.setPolyphony(params.polyphony);
+    synth.setStealPolicy(params.stealPolicy);
+    synth.setMpeMode(params.mpe.enabled);
+    synth.setParallelRendering(params.parallelVoices && !offlineRenderer);
+    if (setOversamplingOrder(params.oversamplingOrder))
+        triggerAsyncUpdate();
+
+    masterGain.setGainLinear(params.masterGain);
+
+    // Nothing sounding and nothing to start: the cleared buffer is already the output.
+    const bool silent = midiQueue.isEmpty() && synth.isSilent();
+    const bool wasSilent = outputSilent.exchange(silent, std::memory_order_relaxed);
+    if (silent)
+    {
+        // Drop the filter history too, the tail left in it is below the voices' silence threshold.
+        if (auto* oversampler = getOversampler(); oversampler != nullptr && !wasSilent)
+            oversampler->reset();
+        masterGain.reset();
+        programFade.setCurrentAndTargetValue(programFade.getTargetValue());
+        publishTelemetry(buffer, startTicks);
+        return;
+    }
 
-    const float gain = apvts.getRawParameterValue("masterGain")->load();
-    masterGain.setGainLinear(gain);
+    // Hosts may hand over more samples than announced in prepareToPlay; the oversamplers and
+    // voices are only sized for that, so larger blocks are rendered in pieces.
+    const auto* nextEvent = midiQueue.begin();
+    const int numSamples = buffer.getNumSamples();
+    for (int start = 0; start < numSamples; start += hostBlockSize)
+    {
+        const int numChunkSamples = juce::jmin(hostBlockSize, numSamples - start);
+        const bool lastChunk = start + numChunkSamples == numSamples;
+
+        float* chunkChannels[2] = {};
+        const int numChunkChannels = juce::jmin(2, buffer.getNumChannels());
+        for (int ch = 0; ch < numChunkChannels; ++ch)
+            chunkChannels[ch] = buffer.getWritePointer(ch, start);
+        juce::AudioBuffer<float> chunk(chunkChannels, numChunkChannels, numChunkSamples);
+
+        if (auto* oversampler = getOversampler())
+        {
+            // The upsampled (silent) input only primes the stage buffers; the voices overwrite them.
+            juce::dsp::AudioBlock<float> block(chunk);
+            auto upBlock = oversampler->processSamplesUp(block);
+            upBlock.clear();
+
+            float* upChannels[2] = {};
+            const int numUpChannels = juce::jmin(2, static_cast<int>(upBlock.getNumChannels()));
+            for (int ch = 0; ch < numUpChannels; ++ch)
+                upChannels[ch] = upBlock.getChannelPointer(static_cast<size_t>(ch));
+
+            juce::AudioBuffer<float> upBuffer(upChannels, numUpChannels, static_cast<int>(upBlock.getNumSamples()));
+            renderSynth(upBuffer, 1 << oversamplingOrder, start, lastChunk, nextEvent);
+            oversampler->processSamplesDown(block);
+        }
+        else
+        {
+            renderSynth(chunk, 1, start, lastChunk, nextEvent);
+        }
+    }
 
     juce::dsp::AudioBlock<float> block(buffer);
     masterGain.process(juce::dsp::ProcessContextReplacing<float>(block));
+    if (programFade.isSmoothing() || programFadingOut)
+        programFade.applyGain(buffer, buffer.getNumSamples());
+
+    publishTelemetry(buffer, startTicks);
+}
+
+void CyqnusAudioProcessor::publishTelemetry(const juce::AudioBuffer<float>& buffer, juce::int64 startTicks)
+{
+    auto& frame = telemetryFrame;
+    frame.processSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    frame.blockSeconds = buffer.getNumSamples() / hostSampleRate;
+    blockLoad.record(frame.processSeconds, frame.blockSeconds);
+
+    const int numChannels = buffer.getNumChannels();
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        // A mono bus shows the same level on both meters.
+        const int source = juce::jmin(ch, numChannels - 1);
+        frame.peak[static_cast<size_t>(ch)] = source >= 0 ? buffer.getMagnitude(source, 0, buffer.getNumSamples()) : 0.0f;
+        frame.rms[static_cast<size_t>(ch)] = source >= 0 ? buffer.getRMSLevel(source, 0, buffer.getNumSamples()) : 0.0f;
+    }
+
+    frame.polyphony = params.polyphony;
+    frame.numStolenVoices = synth.getNumStolenVoices();
+    frame.numActiveVoices = 0;
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+    {
+        // Every voice is a SynthVoice (see the constructor).
+        const auto state = static_cast<SynthVoice*>(synth.getVoice(i))->getEnvelopeState();
+        frame.voiceState[static_cast<size_t>(i)] = state;
+        if (state != AHDSR::State::Idle)
+            ++frame.numActiveVoices;
+    }
+
+    telemetry.push(frame);
+}
+
+void CyqnusAudioProcessor::renderSynth(juce::AudioBuffer<float>& buffer, int positionScale, int hostStart,
+                                       bool lastChunk, const MidiEventQueue::Event*& nextEvent)
+{
+    // Split the block at each event so note starts are sample accurate without handing
+    // the synth a MidiBuffer to iterate. Event positions are at the host rate and are
+    // scaled up when buffer is oversampled.
+    const int numSamples = buffer.getNumSamples();
+    const int hostEnd = hostStart + numSamples / positionScale;
+    int position = 0;
+
+    for (; nextEvent != midiQueue.end() && (lastChunk || nextEvent->samplePosition < hostEnd); ++nextEvent)
+    {
+        const auto& event = *nextEvent;
+        const int eventPosition = juce::jlimit(0, numSamples, (event.samplePosition - hostStart) * positionScale);
+        if (eventPosition > position)
+        {
+            synth.renderNextBlock(buffer, noMidi, position, eventPosition - position);
+            position = eventPosition;
+        }
+
+        synth.handleMidiEvent(event.toMessage());
+    }
+
+    if (position < numSamples)
+        synth.renderNextBlock(buffer, noMidi, position, numSamples - position);
 }
 
 //==============================================================================
@@ -178,15 +548,23 @@ juce::AudioProcessorEditor* CyqnusAudioProcessor::createEditor()
 //==============================================================================
 void CyqnusAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    auto state = apvts.copyState();
-    if (auto xml = state.createXml())
-        copyXmlToBinary(*xml, destData);
+    destData.reset();
+    presetFormat.write(destData);
 }
 
 void CyqnusAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    if (auto xml = getXmlFromBinary(data, sizeInBytes))
-        apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    if (sizeInBytes <= 0)
+        return;
+
+    beginParameterSwap();
+    if (!presetFormat.read(data, static_cast<size_t>(sizeInBytes)))
+    {
+        // States saved before the binary format: the apvts ValueTree as XML.
+        if (auto xml = getXmlFromBinary(data, sizeInBytes))
+            apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    }
+    finishParameterSwap();
 }
 
 //==============================================================================
@@ -211,8 +589,32 @@ juce::AudioProcessorValueTreeState::ParameterLayout CyqnusAudioProcessor::create
     params.push_back(std::make_unique<FloatParam>("ampDecay", "Decay", secondsRange, 1.0f));
     params.push_back(std::make_unique<FloatParam>("ampSustain", "Sustain", sustainRange, 0.5f));
     params.push_back(std::make_unique<FloatParam>("ampRelease", "Release", secondsRange, 0.01f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("ampCurve", "Amp Curve", juce::StringArray{ "Linear", "Exponential" }, 0));
+
+    auto cutoffRange = Range(20.0f, 20000.0f, 0.0f, 0.25f);
+    auto resonanceRange = Range(0.0f, 1.0f);
+    auto filterEnvRange = Range(-8.0f, 8.0f);
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("filterType", "Filter Type", juce::StringArray{ "Off", "Low-pass", "High-pass", "Band-pass" }, 0));
+    params.push_back(std::make_unique<FloatParam>("filterCutoff", "Filter Cutoff", cutoffRange, 20000.0f));
+    params.push_back(std::make_unique<FloatParam>("filterResonance", "Filter Resonance", resonanceRange, 0.1f));
+    params.push_back(std::make_unique<FloatParam>("filterEnvAmount", "Filter Env Amount", filterEnvRange, 0.0f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("filterModRate", "Filter Mod Rate", juce::StringArray{ "Sub-block", "Block" }, 0));
+    params.push_back(std::make_unique<FloatParam>("filterAttack", "Filter Attack", secondsRange, 0.01f));
+    params.push_back(std::make_unique<FloatParam>("filterHold", "Filter Hold", secondsRange, 0.0f));
+    params.push_back(std::make_unique<FloatParam>("filterDecay", "Filter Decay", secondsRange, 1.0f));
+    params.push_back(std::make_unique<FloatParam>("filterSustain", "Filter Sustain", sustainRange, 0.5f));
+    params.push_back(std::make_unique<FloatParam>("filterRelease", "Filter Release", secondsRange, 0.01f));
 
     params.push_back(std::make_unique<FloatParam>("masterGain", "Master Gain", gainRange, 0.8f));
+    params.push_back(std::make_unique<juce::AudioParameterInt>("polyphony", "Polyphony", 1, CyqnusSynthesiser::maxVoices, 8));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("voiceSteal", "Voice Stealing", juce::StringArray{ "Released first", "Oldest", "Quietest", "Same note" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("parallelVoices", "Parallel Voice Rendering", false));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("voiceBank", "Voice Bank Engine", false));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("mpe", "MPE Mode", false));
+    params.push_back(std::make_unique<juce::AudioParameterInt>("mpeBendRange", "MPE Note Bend Range", 1, 96, 48));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("oversampling", "Oversampling", juce::StringArray{ "Off", "2x", "4x", "8x" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("oscQuality", "Oscillator Quality", juce::StringArray{ "Naive", "PolyBLEP", "Wavetable" }, 1));
 
     auto oscWaveChoices = juce::StringArray{ "Sine", "Saw", "Square", "Triangle", "Pulse", "Noise" };
     auto oscLevelRange = Range{ 0.0f, 1.0f };
@@ -220,6 +622,9 @@ juce::AudioProcessorValueTreeState::ParameterLayout CyqnusAudioProcessor::create
     auto oscFineRange = Range{ -100.0f, 100.0f };
     auto oscPWRange = Range{ 0.01f, 0.99f };
     auto oscDetuneRange = Range{ 0.0f, 10.0f };
+    auto oscSpreadRange = Range{ 0.0f, 100.0f };
+    auto oscBlendRange = Range{ 0.0f, 1.0f };
+    auto oscNoiseChoices = juce::StringArray{ "White", "Pink", "Brown" };
 
     // o1
     params.push_back(std::make_unique<juce::AudioParameterChoice>("osc1Wave", "Osc 1 Waveform", oscWaveChoices, 0));
@@ -228,6 +633,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout CyqnusAudioProcessor::create
     params.push_back(std::make_unique<FloatParam>("osc1Fine", "Osc 1 Fine", oscFineRange, 0.0f));
     params.push_back(std::make_unique<FloatParam>("osc1PW", "Osc 1 PulseWidth", oscPWRange, 0.5f));
     params.push_back(std::make_unique<FloatParam>("osc1Detune", "Osc 1 Detune", oscDetuneRange, 0.0f));
+    params.push_back(std::make_unique<juce::AudioParameterInt>("osc1Unison", "Osc 1 Unison Voices", 1, Oscillator::maxUnison, 1));
+    params.push_back(std::make_unique<FloatParam>("osc1Spread", "Osc 1 Unison Spread", oscSpreadRange, 20.0f));
+    params.push_back(std::make_unique<FloatParam>("osc1Blend", "Osc 1 Unison Blend", oscBlendRange, 0.5f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("osc1Noise", "Osc 1 Noise Colour", oscNoiseChoices, 0));
     // o2
     params.push_back(std::make_unique<juce::AudioParameterChoice>("osc2Wave", "Osc 2 Waveform", oscWaveChoices, 0));
     params.push_back(std::make_unique<FloatParam>("osc2Level", "Osc 2 Level", oscLevelRange, 0.8f));
@@ -235,6 +644,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout CyqnusAudioProcessor::create
     params.push_back(std::make_unique<FloatParam>("osc2Fine", "Osc 2 Fine", oscFineRange, 0.0f));
     params.push_back(std::make_unique<FloatParam>("osc2PW", "Osc 2 PulseWidth", oscPWRange, 0.5f));
     params.push_back(std::make_unique<FloatParam>("osc2Detune", "Osc 2 Detune", oscDetuneRange, 0.0f));
+    params.push_back(std::make_unique<juce::AudioParameterInt>("osc2Unison", "Osc 2 Unison Voices", 1, Oscillator::maxUnison, 1));
+    params.push_back(std::make_unique<FloatParam>("osc2Spread", "Osc 2 Unison Spread", oscSpreadRange, 20.0f));
+    params.push_back(std::make_unique<FloatParam>("osc2Blend", "Osc 2 Unison Blend", oscBlendRange, 0.5f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("osc2Noise", "Osc 2 Noise Colour", oscNoiseChoices, 0));
     // o3
     params.push_back(std::make_unique<juce::AudioParameterChoice>("osc3Wave", "Osc 3 Waveform", oscWaveChoices, 0));
     params.push_back(std::make_unique<FloatParam>("osc3Level", "Osc 3 Level", oscLevelRange, 0.8f));
@@ -242,6 +655,36 @@ juce::AudioProcessorValueTreeState::ParameterLayout CyqnusAudioProcessor::create
     params.push_back(std::make_unique<FloatParam>("osc3Fine", "Osc 3 Fine", oscFineRange, 0.0f));
     params.push_back(std::make_unique<FloatParam>("osc3PW", "Osc 3 PulseWidth", oscPWRange, 0.5f));
     params.push_back(std::make_unique<FloatParam>("osc3Detune", "Osc 3 Detune", oscDetuneRange, 0.0f));
+    params.push_back(std::make_unique<juce::AudioParameterInt>("osc3Unison", "Osc 3 Unison Voices", 1, Oscillator::maxUnison, 1));
+    params.push_back(std::make_unique<FloatParam>("osc3Spread", "Osc 3 Unison Spread", oscSpreadRange, 20.0f));
+    params.push_back(std::make_unique<FloatParam>("osc3Blend", "Osc 3 Unison Blend", oscBlendRange, 0.5f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("osc3Noise", "Osc 3 Noise Colour", oscNoiseChoices, 0));
+
+    auto lfoRateRange = Range{ 0.01f, 30.0f, 0.0f, 0.3f };
+    auto lfoShapeChoices = juce::StringArray{ "Sine", "Triangle", "Saw", "Square", "Sample & Hold" };
+    auto modAmountRange = Range{ -1.0f, 1.0f };
+    auto modSourceChoices = juce::StringArray{ "Off" };
+    modSourceChoices.addArray(ModMatrix::getSourceNames());
+
+    params.push_back(std::make_unique<FloatParam>("lfo1Rate", "LFO 1 Rate", lfoRateRange, 2.0f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("lfo1Shape", "LFO 1 Shape", lfoShapeChoices, 0));
+    params.push_back(std::make_unique<FloatParam>("lfo2Rate", "LFO 2 Rate", lfoRateRange, 0.5f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("lfo2Shape", "LFO 2 Shape", lfoShapeChoices, 1));
+    params.push_back(std::make_unique<FloatParam>("modAttack", "Mod Env Attack", secondsRange, 0.01f));
+    params.push_back(std::make_unique<FloatParam>("modHold", "Mod Env Hold", secondsRange, 0.0f));
+    params.push_back(std::make_unique<FloatParam>("modDecay", "Mod Env Decay", secondsRange, 1.0f));
+    params.push_back(std::make_unique<FloatParam>("modSustain", "Mod Env Sustain", sustainRange, 0.5f));
+    params.push_back(std::make_unique<FloatParam>("modRelease", "Mod Env Release", secondsRange, 0.01f));
+    params.push_back(std::make_unique<FloatParam>("voiceSpread", "Voice Stereo Spread", Range{ 0.0f, 1.0f }, 0.0f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("modControlRate", "Mod Control Rate", juce::StringArray{ "8 samples", "16 samples", "32 samples", "64 samples" }, 2));
+
+    for (int i = 1; i <= ModMatrix::numSlots; ++i)
+    {
+        const juce::String id = "mod" + juce::String(i), name = "Mod " + juce::String(i);
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(id + "Source", name + " Source", modSourceChoices, 0));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(id + "Dest", name + " Destination", ModMatrix::getDestinationNames(), 0));
+        params.push_back(std::make_unique<FloatParam>(id + "Amount", name + " Amount", modAmountRange, 0.0f));
+    }
 
     return { params.begin(), params.end() };
 }
\ No newline at end of file
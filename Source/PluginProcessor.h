@@ -11,15 +11,28 @@
 #include <JuceHeader.h>
 #include "SynthVoice.h"
 #include "SynthSound.h"
+#include "WavetableBank.h"
+#include "ParameterSnapshot.h"
+#include "MidiEventQueue.h"
+#include "CyqnusSynthesiser.h"
+#include "EngineTelemetry.h"
+#include "LoadHistogram.h"
+#include "PresetFormat.h"
+#include "PresetBank.h"
 
 //==============================================================================
 /**
 */
-class CyqnusAudioProcessor : public juce::AudioProcessor
+class CyqnusAudioProcessor : public juce::AudioProcessor,
+                             private juce::AsyncUpdater,
+                             private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     //==============================================================================
-    CyqnusAudioProcessor();
+    // An offline renderer renders its voices serially, so it starts no realtime workers, and
+    // opens no preset bank until loadPresetBank is called. Tools running several of them at
+    // once want that.
+    explicit CyqnusAudioProcessor(bool forOfflineRendering = false);
     ~CyqnusAudioProcessor() override;
 
     //==============================================================================
@@ -55,17 +68,96 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
+    // Loads a saved state file: the binary format, or the older XML of the parameter tree
+    // either as plain text or as written by copyXmlToBinary.
+    juce::Result loadStateFile(const juce::File& file);
+
+    // The programs are the presets of a memory-mapped PresetBank; the default bank is opened
+    // at startup when it exists.
+    static juce::File getDefaultPresetBankFile();
+    bool loadPresetBank(const juce::File& file);
+    // Builds a bank from saved states (binary or legacy XML), one preset per file named after it.
+    juce::Result writePresetBank(const juce::File& bankFile, const juce::Array<juce::File>& stateFiles);
+
+    // True when the last processed block was silence (no sounding voices and no MIDI).
+    bool isOutputSilent() const noexcept { return outputSilent.load(std::memory_order_relaxed); }
+
     juce::AudioProcessorValueTreeState apvts;
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::MidiKeyboardState keyboardState;
 
+    // Filled once per processBlock on the audio thread, drained by the editor.
+    EngineTelemetry telemetry;
+
+    // processBlock and per-voice render times as a share of their realtime budget.
+    LoadHistogram blockLoad;
+    LoadHistogram voiceLoad;
+
 private:
-    juce::Synthesiser synth;
-    static constexpr int kNumVoice = 8;
+    WavetableBank wavetables;
+    ParameterCache parameterCache{ apvts };
+    ParameterSnapshot params;
+    VoiceBank voiceBank{ params, wavetables };
+    CyqnusSynthesiser synth;
+    PresetFormat presetFormat{ *this };
+    PresetBank presetBank{ presetFormat };
+    int currentProgram = 0;
+    bool offlineRenderer = false;
+
+    // Program changes and state loads set the parameters on the message thread and prepare
+    // pendingParams from them, while the audio thread keeps rendering its own snapshot. The
+    // audio thread then takes pendingParams at a block boundary: right away when nothing is
+    // ringing, otherwise at the bottom of a short fade-out, fading back in after the swap.
+    enum class ParameterSwap { Idle, Preparing, Ready, Swapping };
+    static constexpr double programFadeSeconds = 0.01;
+    void beginParameterSwap();
+    void finishParameterSwap();
+    void updateParameterSwap();
+
+    std::atomic<ParameterSwap> parameterSwap{ ParameterSwap::Idle };
+    ParameterSnapshot pendingParams;
+    juce::SmoothedValue<float> programFade{ 1.0f };
+    bool programFadingOut = false;
+
+    // MIDI Program Change selects a bank preset; loading it is handed to the message thread,
+    // as is reporting the latency of a new oversampling order.
+    void handleAsyncUpdate() override;
+    std::atomic<int> requestedProgram{ -1 };
+    std::atomic<bool> programChangedOffline{ false };
+
+    // Switching parallel voice rendering on starts the render pool's workers, again from
+    // handleAsyncUpdate.
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    // Renders one piece of the host block, buffer running at positionScale times the host
+    // rate from hostStart. Handles the queued events that fall in it, the last piece taking
+    // any that are left.
+    void renderSynth(juce::AudioBuffer<float>& buffer, int positionScale, int hostStart,
+                     bool lastChunk, const MidiEventQueue::Event*& nextEvent);
+    void publishTelemetry(const juce::AudioBuffer<float>& buffer, juce::int64 startTicks);
+
+    // Voices render at 2^order times the host rate and are filtered back down. One
+    // oversampler per order is built in prepareToPlay, so switching never allocates.
+    // Returns true when the order changed and the new latency still has to be reported.
+    static constexpr int maxOversamplingOrder = 3;
+    bool setOversamplingOrder(int order);
+    juce::dsp::Oversampling<float>* getOversampler() const;
+
+    std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, maxOversamplingOrder> oversamplers;
+    int oversamplingOrder = -1;
+    std::atomic<int> oversamplingLatency{ 0 };
+    double hostSampleRate = 44100.0;
+    int hostBlockSize = 512;
 
     juce::dsp::Gain<float> masterGain;
     juce::dsp::ProcessSpec procSpec;
 
+    juce::MidiBuffer keyboardMidi;
+    juce::MidiBuffer noMidi;
+    MidiEventQueue midiQueue;
+    std::atomic<bool> outputSilent{ true };
+    TelemetryFrame telemetryFrame;
+
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CyqnusAudioProcessor)
 };
@@ -0,0 +1,135 @@
+#include "PresetBank.h"
+
+PresetBank::PresetBank(const PresetFormat& format)
+	: format(format) {
+}
+
+bool PresetBank::open(const juce::File& file) {
+	close();
+	if (!file.existsAsFile())
+		return false;
+
+	auto newMapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+	const auto* data = static_cast<const char*>(newMapping->getData());
+	const size_t size = newMapping->getSize();
+	if (data == nullptr || size < headerSize || juce::ByteOrder::littleEndianInt(data) != bankMagic
+		|| juce::ByteOrder::littleEndianShort(data + 4) > bankVersion)
+		return false;
+
+	const size_t numParameters = juce::ByteOrder::littleEndianShort(data + 6);
+	const size_t count = juce::ByteOrder::littleEndianInt(data + 8);
+	const size_t indexOffset = headerSize + numParameters * 4;
+	const size_t newRecordSize = numParameters * sizeof(float);
+	if (size < indexOffset + count * indexEntrySize)
+		return false;
+
+	// Every record is checked here so apply() can copy without bounds checks.
+	for (size_t i = 0; i < count; ++i) {
+		const size_t offset = juce::ByteOrder::littleEndianInt(data + indexOffset + i * indexEntrySize + nameSize);
+		if (offset > size || size - offset < newRecordSize)
+			return false;
+	}
+
+	std::vector<bool> stored(static_cast<size_t>(format.getNumParameters()), false);
+	recordParameters.clear();
+	for (size_t i = 0; i < numParameters; ++i) {
+		const int p = format.indexOf(juce::ByteOrder::littleEndianInt(data + headerSize + i * 4));
+		recordParameters.push_back(p >= 0 ? format.getParameter(p) : nullptr);
+		if (p >= 0)
+			stored[static_cast<size_t>(p)] = true;
+	}
+
+	missingParameters.clear();
+	for (int p = 0; p < format.getNumParameters(); ++p)
+		if (!stored[static_cast<size_t>(p)])
+			missingParameters.push_back(format.getParameter(p));
+
+	values.assign(numParameters, 0.0f);
+	mapping = std::move(newMapping);
+	index = data + indexOffset;
+	recordSize = newRecordSize;
+	numPresets = static_cast<int>(count);
+	return true;
+}
+
+void PresetBank::close() {
+	numPresets = 0;
+	index = nullptr;
+	mapping.reset();
+}
+
+const char* PresetBank::getIndexEntry(int i) const {
+	jassert(juce::isPositiveAndBelow(i, numPresets));
+	return index + static_cast<size_t>(i) * indexEntrySize;
+}
+
+juce::String PresetBank::getName(int i) const {
+	if (!juce::isPositiveAndBelow(i, numPresets))
+		return {};
+
+	const auto* name = getIndexEntry(i);
+	return juce::String::fromUTF8(name, static_cast<int>(strnlen(name, nameSize)));
+}
+
+void PresetBank::apply(int i) {
+	if (!juce::isPositiveAndBelow(i, numPresets))
+		return;
+
+	const size_t offset = juce::ByteOrder::littleEndianInt(getIndexEntry(i) + nameSize);
+	std::memcpy(values.data(), static_cast<const char*>(mapping->getData()) + offset, recordSize);
+
+	for (size_t p = 0; p < values.size(); ++p) {
+		if (recordParameters[p] == nullptr)
+			continue;
+		auto value = values[p];
+		if (juce::ByteOrder::isBigEndian()) {
+			juce::uint32 bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			bits = juce::ByteOrder::swap(bits);
+			std::memcpy(&value, &bits, sizeof(value));
+		}
+		recordParameters[p]->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, value));
+	}
+
+	for (auto* parameter : missingParameters)
+		parameter->setValueNotifyingHost(parameter->getDefaultValue());
+}
+
+juce::Result PresetBank::write(const juce::File& file, const PresetFormat& format,
+	const juce::StringArray& names, const std::vector<std::vector<float>>& values) {
+	jassert(static_cast<size_t>(names.size()) == values.size());
+	const int numParameters = format.getNumParameters();
+	const size_t count = values.size();
+	const size_t recordsOffset = headerSize + static_cast<size_t>(numParameters) * 4 + count * indexEntrySize;
+	const size_t recordSize = static_cast<size_t>(numParameters) * sizeof(float);
+
+	juce::MemoryBlock block;
+	juce::MemoryOutputStream out(block, false);
+	out.writeInt(static_cast<int>(bankMagic));
+	out.writeShort(static_cast<short>(bankVersion));
+	out.writeShort(static_cast<short>(numParameters));
+	out.writeInt(static_cast<int>(count));
+	out.writeInt(0);
+
+	for (int p = 0; p < numParameters; ++p)
+		out.writeInt(static_cast<int>(format.getHash(p)));
+
+	for (size_t i = 0; i < count; ++i) {
+		char name[nameSize] = {};
+		names[static_cast<int>(i)].copyToUTF8(name, nameSize);
+		out.write(name, nameSize);
+		out.writeInt(static_cast<int>(recordsOffset + i * recordSize));
+	}
+
+	for (const auto& record : values) {
+		if (static_cast<int>(record.size()) != numParameters)
+			return juce::Result::fail("Preset record does not match the parameter list");
+		for (auto value : record)
+			out.writeFloat(value);
+	}
+
+	out.flush();
+	if (!file.replaceWithData(block.getData(), block.getSize()))
+		return juce::Result::fail("Could not write " + file.getFullPathName());
+	return juce::Result::ok();
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include <JuceHeader.h>
+#include "PresetFormat.h"
+
+// Read-only bank of presets in one memory-mapped file. The header and index are checked
+// once in open(); switching presets is then an index lookup and a copy of one fixed-size
+// value record out of the mapping, with no parsing. Little-endian throughout:
+//
+//   uint32 magic 'CYQB', uint16 version, uint16 numParameters, uint32 numPresets, uint32 reserved
+//   numParameters x uint32 idHash           order of the values in every record
+//   numPresets x { char name[32], uint32 offset }
+//   at each offset: numParameters x float32 normalised value
+class PresetBank {
+public:
+	static constexpr juce::uint32 bankMagic = 0x42515943; // "CYQB"
+	static constexpr juce::uint16 bankVersion = 1;
+	static constexpr int nameSize = 32; // including the terminating zero
+
+	explicit PresetBank(const PresetFormat& format);
+
+	// Maps the file and matches its parameters to the processor's. Leaves the bank empty and
+	// returns false if the file is missing or malformed.
+	bool open(const juce::File& file);
+	void close();
+
+	int getNumPresets() const { return numPresets; }
+	juce::String getName(int index) const;
+
+	// Sets every parameter from preset `index`; those the bank doesn't store go back to their default.
+	void apply(int index);
+
+	// Writes a bank whose records hold the normalised values of format's parameters, in its order.
+	static juce::Result write(const juce::File& file, const PresetFormat& format,
+		const juce::StringArray& names, const std::vector<std::vector<float>>& values);
+
+private:
+	static constexpr size_t headerSize = 16;
+	static constexpr size_t indexEntrySize = nameSize + 4;
+
+	const char* getIndexEntry(int index) const;
+
+	const PresetFormat& format;
+	std::unique_ptr<juce::MemoryMappedFile> mapping;
+	int numPresets = 0;
+	size_t recordSize = 0;
+	const char* index = nullptr;
+
+	// By record position; nullptr where the bank stores a parameter this version doesn't have.
+	std::vector<juce::RangedAudioParameter*> recordParameters;
+	std::vector<juce::RangedAudioParameter*> missingParameters;
+	std::vector<float> values; // one record, copied out of the mapping
+
+	JUCE_DECLARE_NON_COPYABLE(PresetBank)
+};
\ No newline at end of file
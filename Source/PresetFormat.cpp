@@ -0,0 +1,77 @@
+#include "PresetFormat.h"
+
+PresetFormat::PresetFormat(juce::AudioProcessor& processor) {
+	for (auto* p : processor.getParameters()) {
+		auto* parameter = dynamic_cast<juce::RangedAudioParameter*>(p);
+		jassert(parameter != nullptr);
+		if (parameter != nullptr)
+			parameters.push_back({ hashParameterID(parameter->getParameterID()), parameter });
+	}
+
+	std::sort(parameters.begin(), parameters.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+	jassert(std::adjacent_find(parameters.begin(), parameters.end(),
+		[](const Entry& a, const Entry& b) { return a.hash == b.hash; }) == parameters.end()); // rename a parameter
+}
+
+juce::uint32 PresetFormat::hashParameterID(const juce::String& parameterID) {
+	juce::uint32 hash = 2166136261u;
+	for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c) {
+		hash ^= static_cast<juce::uint8>(*c);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+bool PresetFormat::isBinaryState(const void* data, size_t size) {
+	return data != nullptr && size >= headerSize && juce::ByteOrder::littleEndianInt(data) == stateMagic;
+}
+
+void PresetFormat::write(juce::MemoryBlock& dest) const {
+	juce::MemoryOutputStream out(dest, false);
+	out.writeInt(static_cast<int>(stateMagic));
+	out.writeShort(static_cast<short>(stateVersion));
+	out.writeShort(static_cast<short>(parameters.size()));
+
+	for (const auto& entry : parameters) {
+		out.writeInt(static_cast<int>(entry.hash));
+		out.writeFloat(entry.parameter->getValue());
+	}
+}
+
+bool PresetFormat::read(const void* data, size_t size) const {
+	if (!isBinaryState(data, size))
+		return false;
+
+	const auto* bytes = static_cast<const char*>(data);
+	const int version = juce::ByteOrder::littleEndianShort(bytes + 4);
+	const size_t numEntries = juce::ByteOrder::littleEndianShort(bytes + 6);
+	if (version > stateVersion || size < headerSize + numEntries * entrySize)
+		return false;
+
+	std::vector<bool> found(parameters.size(), false);
+
+	for (size_t i = 0; i < numEntries; ++i) {
+		const auto* entry = bytes + headerSize + i * entrySize;
+		const int index = indexOf(juce::ByteOrder::littleEndianInt(entry));
+		if (index < 0)
+			continue; // a parameter this version doesn't have
+
+		const auto bits = juce::ByteOrder::littleEndianInt(entry + 4);
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		parameters[static_cast<size_t>(index)].parameter->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, value));
+		found[static_cast<size_t>(index)] = true;
+	}
+
+	for (size_t i = 0; i < parameters.size(); ++i)
+		if (!found[i])
+			parameters[i].parameter->setValueNotifyingHost(parameters[i].parameter->getDefaultValue());
+
+	return true;
+}
+
+int PresetFormat::indexOf(juce::uint32 idHash) const {
+	const auto it = std::lower_bound(parameters.begin(), parameters.end(), idHash,
+		[](const Entry& e, juce::uint32 h) { return e.hash < h; });
+	return (it != parameters.end() && it->hash == idHash) ? static_cast<int>(it - parameters.begin()) : -1;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Compact binary plugin state: a header, then one { parameter ID hash, normalised value }
+// pair per parameter, all little-endian. Loading needs no parsing beyond a sorted lookup
+// per value. States saved before this format (the apvts ValueTree as XML) are recognised
+// by their missing magic and left to the caller's XML path.
+//
+//   uint32 magic 'CYQS', uint16 version, uint16 numParameters
+//   numParameters x { uint32 idHash, float32 value }
+class PresetFormat {
+public:
+	static constexpr juce::uint32 stateMagic = 0x53515943; // "CYQS"
+	static constexpr juce::uint16 stateVersion = 1;
+	static constexpr size_t headerSize = 8;
+	static constexpr size_t entrySize = 8;
+
+	// Every parameter of the processor must be a RangedAudioParameter (all apvts ones are).
+	explicit PresetFormat(juce::AudioProcessor& processor);
+
+	// FNV-1a of the parameter ID, which is what states and banks store.
+	static juce::uint32 hashParameterID(const juce::String& parameterID);
+	static bool isBinaryState(const void* data, size_t size);
+
+	void write(juce::MemoryBlock& dest) const;
+	// Sets every parameter from the state; those it doesn't mention go back to their default.
+	// Returns false, changing nothing, if data isn't a state in this format.
+	bool read(const void* data, size_t size) const;
+
+	int indexOf(juce::uint32 idHash) const; // -1 when no parameter has this hash
+	int getNumParameters() const { return static_cast<int>(parameters.size()); }
+	juce::uint32 getHash(int index) const { return parameters[static_cast<size_t>(index)].hash; }
+	juce::RangedAudioParameter* getParameter(int index) const { return parameters[static_cast<size_t>(index)].parameter; }
+
+private:
+	struct Entry {
+		juce::uint32 hash;
+		juce::RangedAudioParameter* parameter;
+	};
+
+	std::vector<Entry> parameters; // sorted by hash
+};
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "RealtimeCheck.h"
+
+#if CYQNUS_CHECK_REALTIME_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+	thread_local int scopeDepth = 0;
+	std::atomic<int> numViolations{ 0 };
+
+	void* allocate(std::size_t size) {
+		if (scopeDepth > 0) {
+			numViolations.fetch_add(1, std::memory_order_relaxed);
+			jassertfalse; // heap allocation on the audio thread
+		}
+
+		if (auto* p = std::malloc(size == 0 ? 1 : size))
+			return p;
+		throw std::bad_alloc();
+	}
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { try { return allocate(size); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { try { return allocate(size); } catch (...) { return nullptr; } }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace RealtimeCheck {
+	int getNumViolations() { return numViolations.load(std::memory_order_relaxed); }
+	Scope::Scope() { ++scopeDepth; }
+	Scope::~Scope() { --scopeDepth; }
+}
+
+#else
+
+namespace RealtimeCheck {
+	int getNumViolations() { return 0; }
+	Scope::Scope() {}
+	Scope::~Scope() {}
+}
+
+#endif
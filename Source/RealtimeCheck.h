@@ -0,0 +1,24 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Debug aid for proving the audio path is allocation-free. When the project is built with
+// CYQNUS_CHECK_REALTIME_ALLOCATIONS=1, global operator new is replaced and any allocation made
+// while a RealtimeCheck::Scope is alive on the current thread is counted and asserts.
+// juce::HeapBlock uses malloc directly, so JUCE containers are only covered through
+// their capacity being reserved up front.
+#ifndef CYQNUS_CHECK_REALTIME_ALLOCATIONS
+#define CYQNUS_CHECK_REALTIME_ALLOCATIONS 0
+#endif
+
+namespace RealtimeCheck {
+	// Number of allocations caught inside a Scope since the process started (0 when the check is disabled).
+	int getNumViolations();
+
+	class Scope {
+	public:
+		Scope();
+		~Scope();
+
+		JUCE_DECLARE_NON_COPYABLE(Scope)
+	};
+}
@@ -1,38 +1,20 @@
 #include "SynthVoice.h"
  
-SynthVoice::SynthVoice(juce::AudioProcessorValueTreeState& state)
-	: apvts(state) {
-	pAttack  = apvts.getRawParameterValue("ampAttack");
-	pHold    = apvts.getRawParameterValue("ampHold");
-	pDecay   = apvts.getRawParameterValue("ampDecay");
-	pSustain = apvts.getRawParameterValue("ampSustain");
-	pRelease = apvts.getRawParameterValue("ampRelease");
-
-	pOsc1Wave = apvts.getRawParameterValue("osc1Wave");
-	pOsc1Level = apvts.getRawParameterValue("osc1Level");
-	pOsc1Coarse = apvts.getRawParameterValue("osc1Coarse");
-	pOsc1Fine = apvts.getRawParameterValue("osc1Fine");
-	pOsc1PW = apvts.getRawParameterValue("osc1PW");
-	pOsc1Detune = apvts.getRawParameterValue("osc1Detune");
-
-	pOsc2Wave = apvts.getRawParameterValue("osc2Wave");
-	pOsc2Level = apvts.getRawParameterValue("osc2Level");
-	pOsc2Coarse = apvts.getRawParameterValue("osc2Coarse");
-	pOsc2Fine = apvts.getRawParameterValue("osc2Fine");
-	pOsc2PW = apvts.getRawParameterValue("osc2PW");
-	pOsc2Detune = apvts.getRawParameterValue("osc2Detune");
-
-	pOsc3Wave = apvts.getRawParameterValue("osc3Wave");
-	pOsc3Level = apvts.getRawParameterValue("osc3Level");
-	pOsc3Coarse = apvts.getRawParameterValue("osc3Coarse");
-	pOsc3Fine = apvts.getRawParameterValue("osc3Fine");
-	pOsc3PW = apvts.getRawParameterValue("osc3PW");
-	pOsc3Detune = apvts.getRawParameterValue("osc3Detune");
-}
-
-void SynthVoice::prepareToPlay(double sampleRate, int) {
+SynthVoice::SynthVoice(const ParameterSnapshot& params, const WavetableBank& wavetables, VoiceBank& voiceBank, int bankSlot)
+	: params(params), voiceBank(voiceBank), bankSlot(bankSlot) {
+	osc1.setWavetableBank(&wavetables);
+	osc2.setWavetableBank(&wavetables);
+	osc3.setWavetableBank(&wavetables);
+}
+
+void SynthVoice::prepareToPlay(double sampleRate, int samplesPerBlock) {
 	this->sampleRate = (sampleRate > 0.0) ? sampleRate : 44100.0;
 	ampEnv.setSampleRate(sampleRate);
+	filterEnv.setSampleRate(sampleRate);
+	filter.setSampleRate(sampleRate);
+	modEnvInterval = 0; // re-rated on the next control period
+	bendRatio.reset(this->sampleRate, bendSmoothingSeconds);
+	oscBuffer.setSize(5, juce::jmax(1, samplesPerBlock));
 
 	osc1.setSampleRate(sampleRate);
 	osc2.setSampleRate(sampleRate);
@@ -43,76 +25,373 @@ bool SynthVoice::canPlaySound(juce::SynthesiserSound* sound) {
 	return dynamic_cast<SynthSound*>(sound) != nullptr;
 }
 
-void SynthVoice::startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int) {
+void SynthVoice::startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int currentPitchWheelPosition) {
 	currentFreq = static_cast<float>(juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber));
 	level = juce::jlimit(0.0f, 1.0f, velocity);
-	phase = 0.0f;
-
-	AHDSR::Params envParams;
-	envParams.attack  = pAttack->load();
-	envParams.hold    = pHold->load();
-	envParams.decay   = pDecay->load();
-	envParams.sustain = pSustain->load();
-	envParams.release = pRelease->load();
-	ampEnv.setParameters(envParams);
+
+	// Both engines place the note in the stereo field the same way.
+	++noteCount;
+	auto panSeed = NoiseGenerator::makeSeed(bankSlot, ModMatrix::numOscillators + ModMatrix::numLfos, noteCount);
+	notePan = params.mod.voiceSpread * NoiseGenerator::toBipolar(NoiseGenerator::step(panSeed));
+
+	onBank = canRenderOnBank();
+	if (onBank) {
+		voiceBank.noteOn(bankSlot, currentFreq, level, notePan);
+		return;
+	}
+
+	osc1.seedNoise(NoiseGenerator::makeSeed(bankSlot, 0, noteCount));
+	osc2.seedNoise(NoiseGenerator::makeSeed(bankSlot, 1, noteCount));
+	osc3.seedNoise(NoiseGenerator::makeSeed(bankSlot, 2, noteCount));
+	for (size_t i = 0; i < lfos.size(); ++i)
+		lfos[i].reset(NoiseGenerator::makeSeed(bankSlot, ModMatrix::numOscillators + static_cast<int>(i), noteCount));
+
+	midiChannel = 1;
+	for (int channel = 1; channel <= 16; ++channel) {
+		if (isPlayingChannel(channel)) {
+			midiChannel = channel;
+			break;
+		}
+	}
+
+	modSources.fill(0.0f);
+	modSources[ModMatrix::Velocity] = level;
+	modSources[ModMatrix::PitchWheel] = toPitchWheel(currentPitchWheelPosition);
+	if (channelStates != nullptr) {
+		const auto& state = channelStates[midiChannel];
+		modSources[ModMatrix::ModWheel] = state.modWheel;
+		modSources[ModMatrix::Aftertouch] = state.pressure;
+		modSources[ModMatrix::Slide] = state.slide;
+	}
+	modEnvCountdown = 0;
+	firstModPeriod = true;
+
+	currentPan = 2.0f;
+
+	// MPE controllers send a note's initial bend ahead of its note-on, so start on it.
+	mpeBend = getMpeBend();
+	bendRatio.setCurrentAndTargetValue(std::exp2(mpeBend / 12.0f));
+
+	updateParameters();
 	ampEnv.noteOn();
+	filterEnv.noteOn();
+	modEnv.noteOn();
+	filter.reset();
 
-	auto configureOsc = [this](Oscillator& osc,
-		std::atomic<float>* wave,
-		std::atomic<float>* level,
-		std::atomic<float>* coarse,
-		std::atomic<float>* fine,
-		std::atomic<float>* pw,
-		std::atomic<float>* detune)
-		{
-			osc.setWaveform(static_cast<Oscillator::Waveform>(static_cast<int>(wave->load())));
-			osc.setLevel(level->load());
-			osc.setCoarse(static_cast<int>(coarse->load()));
-			osc.setFinetune(fine->load());
-			osc.setPulseWidth(pw->load());
-			osc.setDetuneSpread(detune->load());
-			osc.setFrequency(currentFreq);
-		};
+	osc1.skipSmoothing();
+	osc2.skipSmoothing();
+	osc3.skipSmoothing();
+}
+
+void SynthVoice::updateParameters() {
+	ampEnv.setParameters(params.amp);
+	filterEnv.setParameters(params.filter.env);
+	modEnv.setParameters(params.mod.env);
+
+	applyOscParameters(osc1, params.osc[0]);
+	applyOscParameters(osc2, params.osc[1]);
+	applyOscParameters(osc3, params.osc[2]);
+}
 
-	configureOsc(osc1, pOsc1Wave, pOsc1Level, pOsc1Coarse, pOsc1Fine, pOsc1PW, pOsc1Detune);
-	configureOsc(osc2, pOsc2Wave, pOsc2Level, pOsc2Coarse, pOsc2Fine, pOsc2PW, pOsc2Detune);
-	configureOsc(osc3, pOsc3Wave, pOsc3Level, pOsc3Coarse, pOsc3Fine, pOsc3PW, pOsc3Detune);
+void SynthVoice::applyOscParameters(Oscillator& osc, const ParameterSnapshot::Osc& p) {
+	// The setters ignore unchanged values, so the phase increment is only recomputed when pitch inputs move.
+	osc.setWaveform(p.wave);
+	osc.setQuality(params.oscQuality);
+	osc.setLevel(p.level);
+	osc.setCoarse(p.coarse);
+	osc.setFinetune(p.fine);
+	osc.setPulseWidth(p.pulseWidth);
+	osc.setDetuneSpread(p.detune);
+	osc.setUnison(p.unison, p.unisonSpread, p.unisonBlend);
+	osc.setNoiseColour(p.noise);
+	osc.setFrequency(currentFreq * bendRatio.getCurrentValue());
 }
 
 void SynthVoice::stopNote(float, bool allowTailOff) {
+	if (onBank) {
+		if (allowTailOff) {
+			voiceBank.noteOff(bankSlot);
+		} else {
+			voiceBank.kill(bankSlot);
+			clearCurrentNote();
+		}
+		return;
+	}
+
 	if (allowTailOff) {
 		ampEnv.noteOff();
+		filterEnv.noteOff();
+		modEnv.noteOff();
 	} else {
 		ampEnv.reset();
+		filterEnv.reset();
+		modEnv.reset();
 		clearCurrentNote();
 	}
 }
 
-void SynthVoice::pitchWheelMoved(int) {}
-void SynthVoice::controllerMoved(int, int) {}
+void SynthVoice::fadeOut(float seconds) {
+	if (onBank)
+		voiceBank.fadeOut(bankSlot, seconds);
+	else
+		ampEnv.fastRelease(seconds);
+}
+
+void SynthVoice::updateFilterCutoff(float envLevel) {
+	filter.setCutoff(VoiceFilter::getModulatedCutoff(params.filter.cutoff, params.filter.envAmount, envLevel),
+		params.filter.resonance);
+}
+
+AHDSR::State SynthVoice::getEnvelopeState() const {
+	if (!isVoiceActive())
+		return AHDSR::State::Idle;
+	return onBank ? voiceBank.getEnvelopeState(bankSlot) : ampEnv.getState();
+}
+
+float SynthVoice::getEnvelopeLevel() const {
+	if (!isVoiceActive())
+		return 0.0f;
+	return onBank ? voiceBank.getEnvelopeLevel(bankSlot) : ampEnv.getLevel();
+}
+
+void SynthVoice::pitchWheelMoved(int newPitchWheelValue) {
+	modSources[ModMatrix::PitchWheel] = toPitchWheel(newPitchWheelValue);
+}
+
+void SynthVoice::controllerMoved(int controllerNumber, int newControllerValue) {
+	if (controllerNumber == modWheelController)
+		modSources[ModMatrix::ModWheel] = newControllerValue / 127.0f;
+	else if (controllerNumber == slideController)
+		modSources[ModMatrix::Slide] = newControllerValue / 127.0f;
+}
+
+// Channel pressure and polyphonic aftertouch on this voice's note drive the same source;
+// whichever arrived last wins.
+void SynthVoice::aftertouchChanged(int newAftertouchValue) {
+	modSources[ModMatrix::Aftertouch] = newAftertouchValue / 127.0f;
+}
+
+void SynthVoice::channelPressureChanged(int newChannelPressureValue) {
+	modSources[ModMatrix::Aftertouch] = newChannelPressureValue / 127.0f;
+}
+
+void SynthVoice::updateModulation(int numSamples) {
+	const auto& mod = params.mod;
+	if (modEnvInterval != mod.controlInterval) {
+		modEnvInterval = mod.controlInterval;
+		modEnv.setSampleRate(sampleRate / modEnvInterval);
+	}
+
+	// One envelope step per full control interval, however the block is split by MIDI events.
+	for (modEnvCountdown -= numSamples; modEnvCountdown < 0; modEnvCountdown += modEnvInterval)
+		modSources[ModMatrix::ModEnv] = modEnv.getNextSample();
+
+	const float seconds = static_cast<float>(numSamples / sampleRate);
+	for (size_t i = 0; i < lfos.size(); ++i)
+		modSources[ModMatrix::Lfo1 + i] = lfos[i].advance(mod.lfo[i], seconds);
+
+	// In MPE mode each note has a member channel to itself, so that channel's controllers are
+	// the note's own; the mod wheel stays on the master channel. Pressure takes over from velocity.
+	float amplitude = level;
+	if (params.mpe.enabled && channelStates != nullptr) {
+		const auto& note = channelStates[midiChannel];
+		modSources[ModMatrix::PitchWheel] = note.pitchWheel;
+		modSources[ModMatrix::ModWheel] = channelStates[mpeMasterChannel].modWheel;
+		modSources[ModMatrix::Aftertouch] = note.pressure;
+		modSources[ModMatrix::Slide] = note.slide;
+		amplitude = note.pressure;
+	}
+
+	const float bend = getMpeBend();
+	if (bend != mpeBend) {
+		mpeBend = bend;
+		bendRatio.setTargetValue(std::exp2(bend / 12.0f));
+	}
+	if (bendRatio.isSmoothing()) {
+		const float frequency = currentFreq * bendRatio.skip(numSamples);
+		osc1.setFrequency(frequency);
+		osc2.setFrequency(frequency);
+		osc3.setFrequency(frequency);
+	}
+
+	ModMatrix::evaluate(mod.routing, modSources, modValues);
+
+	// The setters ignore unchanged values, so unrouted destinations cost a compare each.
+	Oscillator* const oscs[] = { &osc1, &osc2, &osc3 };
+	for (int i = 0; i < ModMatrix::numOscillators; ++i) {
+		const auto& p = params.osc[static_cast<size_t>(i)];
+		auto value = [&](ModMatrix::OscDestination d) { return modValues[static_cast<size_t>(ModMatrix::getDestination(i, d))]; };
+
+		oscs[i]->setPitchModulation(value(ModMatrix::Pitch) * ModMatrix::pitchRange);
+		oscs[i]->setPulseWidth(p.pulseWidth + value(ModMatrix::PulseWidth) * ModMatrix::pulseWidthRange);
+		oscs[i]->setDetuneSpread(p.detune + value(ModMatrix::Detune) * ModMatrix::detuneRange);
+
+		const auto o = static_cast<size_t>(i);
+		const float gain = juce::jlimit(0.0f, 2.0f, 1.0f + value(ModMatrix::Level) * ModMatrix::levelRange);
+		levelRampStart[o] = firstModPeriod ? gain : levelRampEnd[o];
+		levelRampEnd[o] = gain;
+	}
+
+	const float pan = juce::jlimit(-1.0f, 1.0f, notePan + modValues[ModMatrix::voicePan] * ModMatrix::panRange);
+	if (pan != currentPan) {
+		currentPan = pan;
+		panGains = VoiceBank::getPanGains(pan);
+	}
+
+	// The three oscillators together reach 3, hence the third.
+	const float gain = amplitude / 3.0f;
+	for (size_t ch = 0; ch < 2; ++ch) {
+		outputGainStart[ch] = firstModPeriod ? gain * panGains[ch] : outputGainEnd[ch];
+		outputGainEnd[ch] = gain * panGains[ch];
+	}
+	firstModPeriod = false;
+}
+
+bool SynthVoice::canRenderOnBank() const {
+	if (!params.voiceBank || params.mod.routing.numRoutes > 0 || params.mpe.enabled)
+		return false;
+
+	for (const auto& osc : params.osc)
+		if (osc.unison > 1 && osc.level > 0.0f)
+			return false;
+	return true;
+}
+
+float SynthVoice::getMpeBend() const {
+	if (!params.mpe.enabled || channelStates == nullptr)
+		return 0.0f;
+
+	const float masterBend = channelStates[mpeMasterChannel].pitchWheel * mpeMasterBendRange;
+	if (midiChannel == mpeMasterChannel)
+		return masterBend;
+	return masterBend + channelStates[midiChannel].pitchWheel * params.mpe.noteBendRange;
+}
+
+void SynthVoice::addWithGainRamp(float* dest, const float* source, int numSamples, float startGain, float endGain) {
+	if (startGain == endGain) {
+		juce::FloatVectorOperations::addWithMultiply(dest, source, startGain, numSamples);
+		return;
+	}
+
+	const float step = (endGain - startGain) / static_cast<float>(numSamples);
+	for (int i = 0; i < numSamples; ++i)
+		dest[i] += source[i] * (startGain + step * static_cast<float>(i + 1));
+}
+
+void SynthVoice::recordLoad() {
+	if (loadSamples == 0)
+		return;
+
+	if (loadHistogram != nullptr)
+		loadHistogram->record(loadSeconds, loadSamples / sampleRate);
+	loadSeconds = 0.0;
+	loadSamples = 0;
+}
+
+void SynthVoice::applyGainRamp(float* left, float* right, int numSamples, float startGain, float endGain) {
+	const float step = (endGain - startGain) / static_cast<float>(numSamples);
+	for (int i = 0; i < numSamples; ++i) {
+		const float gain = startGain + step * static_cast<float>(i + 1);
+		left[i] *= gain;
+		right[i] *= gain;
+	}
+}
 
 void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& output, int startSample, int numSamples)
 {
+	// The bank renders all of its voices at once (CyqnusSynthesiser::renderVoices); only
+	// pick up whether this note has finished.
+	if (onBank)
+	{
+		if (!voiceBank.isActive(bankSlot))
+			clearCurrentNote();
+		return;
+	}
+
 	if (!ampEnv.isActive())
 	{
 		clearCurrentNote();
 		return;
 	}
 
+	const auto startTicks = juce::Time::getHighResolutionTicks();
+	updateParameters();
+
+	// Voices only ever render into the synth's stereo voice bus (or a render pool lane sized like it).
+	jassert(output.getNumChannels() > 1);
 	auto* left = output.getWritePointer(0, startSample);
-	auto* right = output.getNumChannels() > 1 ? output.getWritePointer(1, startSample) : nullptr;
+	auto* right = output.getWritePointer(1, startSample);
 
-	for (int i = 0; i < numSamples; ++i)
+	// Oscillators render in stereo so unison copies can be spread.
+	auto* mixLeft = oscBuffer.getWritePointer(0);
+	auto* mixRight = oscBuffer.getWritePointer(1);
+	auto* scratchLeft = oscBuffer.getWritePointer(2);
+	auto* scratchRight = oscBuffer.getWritePointer(3);
+	auto* envelope = oscBuffer.getWritePointer(4);
+	Oscillator* const oscs[] = { &osc1, &osc2, &osc3 };
+
+	for (int offset = 0; offset < numSamples;)
 	{
-		float oscMix = (osc1.getNextSample() + osc2.getNextSample() + osc3.getNextSample()) / 3.0f;
+		const int n = juce::jmin(numSamples - offset, params.mod.controlInterval, oscBuffer.getNumSamples());
+		updateModulation(n);
 
-		float env = ampEnv.getNextSample();
-		float sample = oscMix * env * level;
+		// The filter envelope runs even with the filter off so switching it on mid-note picks up in step.
+		ampEnv.renderBlock(envelope, n);
+		filterEnv.renderBlock(scratchRight, n);
+		if (offset == 0 || !params.filter.blockRate)
+			updateFilterCutoff(scratchRight[n - 1]);
 
-		left[i] += sample;
-		if (right) right[i] += sample;
+		// A note held at zero sustain (or the tail of a release) would only be multiplied by
+		// zero; keep the oscillators in step and skip the render, filter and mix.
+		if (juce::FloatVectorOperations::findMaximum(envelope, n) < AHDSR::silenceThreshold)
+		{
+			for (auto* osc : oscs)
+				if (!osc->isSilent())
+					osc->advance(n);
+
+			offset += n;
+			continue;
+		}
+
+		// Oscillators at zero level are skipped; the first audible one renders straight into the mix.
+		int numAudible = 0;
+		for (int i = 0; i < ModMatrix::numOscillators; ++i)
+		{
+			auto* osc = oscs[i];
+			if (osc->isSilent())
+				continue;
+
+			const bool intoMix = numAudible++ == 0;
+			auto* oscLeft = intoMix ? mixLeft : scratchLeft;
+			auto* oscRight = intoMix ? mixRight : scratchRight;
+			osc->renderBlock(oscLeft, oscRight, n);
+
+			if (params.mod.routing.isRouted[static_cast<size_t>(ModMatrix::getDestination(i, ModMatrix::Level))])
+				applyGainRamp(oscLeft, oscRight, n, levelRampStart[static_cast<size_t>(i)], levelRampEnd[static_cast<size_t>(i)]);
+
+			if (!intoMix)
+			{
+				juce::FloatVectorOperations::add(mixLeft, scratchLeft, n);
+				juce::FloatVectorOperations::add(mixRight, scratchRight, n);
+			}
+		}
+
+		if (numAudible > 0)
+		{
+			filter.process(params.filter.type, mixLeft, mixRight, n);
+			juce::FloatVectorOperations::multiply(mixLeft, envelope, n);
+			juce::FloatVectorOperations::multiply(mixRight, envelope, n);
+
+			addWithGainRamp(left + offset, mixLeft, n, outputGainStart[0], outputGainEnd[0]);
+			addWithGainRamp(right + offset, mixRight, n, outputGainStart[1], outputGainEnd[1]);
+		}
+
+		offset += n;
 	}
 
+	loadSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+	loadSamples += numSamples;
+
 	if (!ampEnv.isActive())
 		clearCurrentNote();
 }
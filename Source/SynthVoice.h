@@ -3,55 +3,111 @@
 #include "AHDSR.h"
 #include "SynthSound.h"
 #include "Oscillator.h"
+#include "VoiceFilter.h"
+#include "WavetableBank.h"
+#include "ParameterSnapshot.h"
+#include "VoiceBank.h"
+#include "LoadHistogram.h"
+#include "ModMatrix.h"
 
 class SynthVoice : public juce::SynthesiserVoice { 
 public:
-	explicit SynthVoice(juce::AudioProcessorValueTreeState& state);
+	static constexpr int modWheelController = 1;
+	static constexpr int slideController = 74;
+	static constexpr int mpeMasterChannel = 1;
+	static constexpr float mpeMasterBendRange = 2.0f; // semitones, the MPE default
+
+	// 14-bit pitch wheel position to -1..1.
+	static float toPitchWheel(int wheelValue) { return juce::jlimit(-1.0f, 1.0f, (wheelValue - 8192) / 8192.0f); }
+
+	// bankSlot is this voice's fixed slot in voiceBank, used when the voice bank engine is selected.
+	SynthVoice(const ParameterSnapshot& params, const WavetableBank& wavetables, VoiceBank& voiceBank, int bankSlot);
 
 	bool canPlaySound(juce::SynthesiserSound* sound) override;
-	void prepareToPlay(double sampleRate, int);
+	void prepareToPlay(double sampleRate, int samplesPerBlock);
 	void startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int) override;
 	void stopNote(float, bool allowTailOff) override;
-	void pitchWheelMoved(int) override;
-	void controllerMoved(int, int) override;
+	// Fades the note out over `seconds` instead of cutting it, for a voice whose note is stolen.
+	void fadeOut(float seconds);
+	void pitchWheelMoved(int newPitchWheelValue) override;
+	void controllerMoved(int controllerNumber, int newControllerValue) override;
+	void aftertouchChanged(int newAftertouchValue) override;
+	void channelPressureChanged(int newChannelPressureValue) override;
 	void renderNextBlock(juce::AudioBuffer<float>& output, int startSample, int numSamples) override;
 
+	// Stage of the amp envelope of the current note, for the editor's voice display.
+	AHDSR::State getEnvelopeState() const;
+	float getEnvelopeLevel() const;
+
+	// The time spent rendering is summed over a host block and recorded into this histogram
+	// (may be shared between voices) by recordLoad, called once the block is done.
+	void setLoadHistogram(LoadHistogram* histogram) { loadHistogram = histogram; }
+	void recordLoad();
+
+	// Per-channel controller values (see CyqnusSynthesiser::getChannelStates) a new note's
+	// wheel, pressure and slide sources start from.
+	void setChannelStates(const MidiChannelState* states) { channelStates = states; }
+
 private:
-	juce::AudioProcessorValueTreeState& apvts;
+	void updateParameters();
+	void applyOscParameters(Oscillator& osc, const ParameterSnapshot::Osc& p);
+	void updateFilterCutoff(float envLevel);
+	// Steps the matrix sources on by numSamples and applies the routing to the oscillators.
+	void updateModulation(int numSamples);
+	static void applyGainRamp(float* left, float* right, int numSamples, float startGain, float endGain);
+	static void addWithGainRamp(float* dest, const float* source, int numSamples, float startGain, float endGain);
+	// Pitch bend in semitones the note's channels ask for, zero outside MPE mode.
+	float getMpeBend() const;
+	// Whether a note starting now can go to voiceBank. The bank evaluates neither the mod
+	// matrix nor MPE's per-note bend, pressure and slide, and has no unison, so notes that
+	// need any of them are rendered here.
+	bool canRenderOnBank() const;
+
+	const ParameterSnapshot& params;
+	VoiceBank& voiceBank;
+	const int bankSlot;
+	bool onBank = false; // the current note is rendered by voiceBank
+	LoadHistogram* loadHistogram = nullptr;
+	double loadSeconds = 0.0;
+	int loadSamples = 0;
 
 	AHDSR ampEnv;
+	AHDSR filterEnv;
+	VoiceFilter filter;
 	Oscillator osc1, osc2, osc3;
+	juce::AudioBuffer<float> oscBuffer;
+	const MidiChannelState* channelStates = nullptr;
+	int midiChannel = 1;
+
+	// Modulation runs once per control period (params.mod.controlInterval samples). The mod
+	// envelope is clocked at the control rate; level routes ramp across each period, and the
+	// oscillators glide pitch, detune and pulse width across it (see Oscillator::beginBlock).
+	std::array<ModLfo, ModMatrix::numLfos> lfos;
+	AHDSR modEnv;
+	int modEnvInterval = 0;  // control interval modEnv's sample rate is set for
+	int modEnvCountdown = 0; // samples until its next step
+	ModMatrix::SourceValues modSources{};
+	ModMatrix::DestinationValues modValues{};
+	std::array<float, ModMatrix::numOscillators> levelRampStart{};
+	std::array<float, ModMatrix::numOscillators> levelRampEnd{};
+	bool firstModPeriod = true; // level ramps start at their target on a new note
 
-	std::atomic<float>* pAttack{ nullptr };
-	std::atomic<float>* pHold{ nullptr };
-	std::atomic<float>* pDecay{ nullptr };
-	std::atomic<float>* pSustain{ nullptr };
-	std::atomic<float>* pRelease{ nullptr };
-
-	std::atomic<float>* pOsc1Wave{ nullptr };
-	std::atomic<float>* pOsc1Level{ nullptr };
-	std::atomic<float>* pOsc1Coarse{ nullptr };
-	std::atomic<float>* pOsc1Fine{ nullptr };
-	std::atomic<float>* pOsc1PW{ nullptr };
-	std::atomic<float>* pOsc1Detune{ nullptr };
-
-	std::atomic<float>* pOsc2Wave{ nullptr };
-	std::atomic<float>* pOsc2Level{ nullptr };
-	std::atomic<float>* pOsc2Coarse{ nullptr };
-	std::atomic<float>* pOsc2Fine{ nullptr };
-	std::atomic<float>* pOsc2PW{ nullptr };
-	std::atomic<float>* pOsc2Detune{ nullptr };
-
-	std::atomic<float>* pOsc3Wave{ nullptr }; 
-	std::atomic<float>* pOsc3Level{ nullptr };
-	std::atomic<float>* pOsc3Coarse{ nullptr };
-	std::atomic<float>* pOsc3Fine{ nullptr };
-	std::atomic<float>* pOsc3PW{ nullptr };
-	std::atomic<float>* pOsc3Detune{ nullptr };
+	// MPE per-note pitch. The bend only becomes a frequency ratio (one exp2) when it changes;
+	// the ratio then glides multiplicatively, stepped once per control period.
+	static constexpr double bendSmoothingSeconds = 0.005;
+	float mpeBend = 0.0f;
+	juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> bendRatio{ 1.0f };
 
+	// The voice adds its stereo mix to the output through one gain per channel: velocity (MPE
+	// pressure in MPE mode) and the voice's pan, ramped across each control period.
+	float notePan = 0.0f; // from the voice spread, fixed for the note
+	float currentPan = 2.0f; // out of range, so the first period computes the pan gains
+	std::array<float, 2> panGains{ 1.0f, 1.0f };
+	std::array<float, 2> outputGainStart{};
+	std::array<float, 2> outputGainEnd{};
 
 	double sampleRate = 44100.0;
 	float  currentFreq = 440.0f;
-	float  phase = 0.0f;
 	float  level = 1.0f;
+	juce::uint32 noteCount = 0; // seeds each note's noise, see NoiseGenerator::makeSeed
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "VoiceAllocator.h"
+
+VoiceAllocator::VoiceAllocator() {
+	reset(0);
+}
+
+void VoiceAllocator::reset(int numVoices) {
+	jassert(numVoices <= maxVoices);
+	head.fill(-1);
+	tail.fill(-1);
+	size.fill(0);
+	freeBits.fill(0);
+
+	for (int v = 0; v < numVoices; ++v)
+		pushBack(Free, v);
+}
+
+int VoiceAllocator::takeFree() {
+	for (size_t word = 0; word < freeBits.size(); ++word) {
+		const juce::uint32 bits = freeBits[word];
+		if (bits == 0)
+			continue;
+
+		const int voice = static_cast<int>(word) * 32 + juce::findHighestSetBit(bits & (~bits + 1u));
+		moveTo(voice, Sounding);
+		return voice;
+	}
+	return -1;
+}
+
+void VoiceAllocator::moveTo(int voice, List list) {
+	unlink(voice);
+	pushBack(list, voice);
+}
+
+void VoiceAllocator::unlink(int voice) {
+	const auto v = static_cast<size_t>(voice);
+	const List list = listOf[v];
+
+	if (prev[v] >= 0)
+		next[static_cast<size_t>(prev[v])] = next[v];
+	else
+		head[list] = next[v];
+
+	if (next[v] >= 0)
+		prev[static_cast<size_t>(next[v])] = prev[v];
+	else
+		tail[list] = prev[v];
+
+	--size[list];
+	if (list == Free)
+		freeBits[v / 32] &= ~(1u << (v % 32));
+}
+
+void VoiceAllocator::pushBack(List list, int voice) {
+	const auto v = static_cast<size_t>(voice);
+	listOf[v] = list;
+	prev[v] = tail[list];
+	next[v] = -1;
+
+	if (tail[list] >= 0)
+		next[static_cast<size_t>(tail[list])] = voice;
+	else
+		head[list] = voice;
+
+	tail[list] = voice;
+	++size[list];
+	if (list == Free)
+		freeBits[v / 32] |= 1u << (v % 32);
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Note allocation bookkeeping for CyqnusSynthesiser. Every voice index sits in exactly one
+// of three intrusive doubly linked lists, so taking a free voice, finding the oldest note
+// and retiring a voice are O(1) however many voices there are. Each list keeps the order
+// voices entered it, oldest at the front.
+class VoiceAllocator {
+public:
+	static constexpr int maxVoices = 256;
+
+	// Which sounding voice a note takes over when the polyphony limit is reached.
+	enum class StealPolicy {
+		ReleasedFirst, // oldest voice whose key is up, else the oldest
+		Oldest,
+		Quietest,      // lowest amp envelope level
+		SameNote       // a repeated note retriggers its own voice; otherwise as ReleasedFirst
+	};
+
+	enum List : juce::uint8 {
+		Free,
+		Sounding, // playing a note that counts against the polyphony limit
+		Fading,   // stolen and fading out, no longer counted
+		numLists
+	};
+
+	VoiceAllocator();
+
+	// Puts voices [0, numVoices) on the free list.
+	void reset(int numVoices);
+
+	// Moves the lowest-numbered free voice to the back of Sounding; -1 when none is free.
+	// Keeping notes on the first indices keeps them within the editor's voice display.
+	int takeFree();
+	void moveTo(int voice, List list);
+
+	List getList(int voice) const { return listOf[static_cast<size_t>(voice)]; }
+	int getFront(List list) const { return head[list]; }
+	int getNext(int voice) const { return next[static_cast<size_t>(voice)]; }
+	int getSize(List list) const { return size[list]; }
+
+private:
+	void unlink(int voice);
+	void pushBack(List list, int voice);
+
+	std::array<int, maxVoices> next;
+	std::array<int, maxVoices> prev;
+	std::array<List, maxVoices> listOf;
+	std::array<int, numLists> head;
+	std::array<int, numLists> tail;
+	std::array<int, numLists> size;
+	std::array<juce::uint32, maxVoices / 32> freeBits{}; // bit v set while voice v is Free
+};
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include "VoiceBank.h"
+#include "OscillatorKernels.h"
+
+namespace {
+	using namespace OscillatorKernels;
+
+	// Adds level * waveFn(phase) to dest and advances the phases, one register of voices per sample.
+	template <typename WaveFn>
+	void accumulate(Vec* dest, int numSamples, juce::uint32* phases, const juce::uint32* steps, float level, WaveFn waveFn) {
+		for (int i = 0; i < numSamples; ++i)
+			dest[i] += waveFn(nextUnitPhases(phases, steps)) * level;
+	}
+}
+
+VoiceBank::VoiceBank(const ParameterSnapshot& params, const WavetableBank& wavetables)
+	: params(params), wavetables(wavetables) {
+	positionOfSlot.fill(-1);
+}
+
+void VoiceBank::prepare(double sr) {
+	sampleRate = (sr > 0.0) ? sr : 44100.0;
+
+	for (auto& env : envelopes)
+		env.setSampleRate(sampleRate);
+	for (auto& env : filterEnvelopes)
+		env.setSampleRate(sampleRate);
+	filterResonance = -1.0f;
+
+	for (int o = 0; o < numOscillators; ++o) {
+		levelSmoothed[o].reset(sampleRate, 0.02);
+		levelSmoothed[o].setCurrentAndTargetValue(params.osc[o].level);
+	}
+
+	// The front-end voices notice on their next render that their notes are gone.
+	numActive = 0;
+	positionOfSlot.fill(-1);
+	for (auto& channelGain : gain)
+		channelGain.fill(0.0f);
+}
+
+void VoiceBank::noteOn(int slot, float freq, float velocity, float pan) {
+	jassert(juce::isPositiveAndBelow(slot, maxVoices));
+
+	int position = positionOfSlot[static_cast<size_t>(slot)];
+	if (position < 0) {
+		position = numActive++;
+		slotAtPosition[static_cast<size_t>(position)] = slot;
+		positionOfSlot[static_cast<size_t>(slot)] = position;
+
+		for (auto& oscPhase : phase)
+			oscPhase[static_cast<size_t>(position)] = 0;
+		filterIc1[static_cast<size_t>(position)] = 0.0f;
+		filterIc2[static_cast<size_t>(position)] = 0.0f;
+		filterCutoff[static_cast<size_t>(position)] = -1.0f;
+	}
+
+	const auto noteIndex = ++noteCount[static_cast<size_t>(slot)];
+	for (int o = 0; o < numOscillators; ++o) {
+		noiseState[o][static_cast<size_t>(position)] = NoiseGenerator::makeSeed(slot, o, noteIndex);
+		noiseFilter[o][static_cast<size_t>(position)] = {};
+	}
+
+	frequency[static_cast<size_t>(position)] = freq;
+	const float voiceGain = juce::jlimit(0.0f, 1.0f, velocity) / static_cast<float>(numOscillators);
+	const auto panGains = getPanGains(pan);
+	for (size_t ch = 0; ch < 2; ++ch)
+		gain[ch][static_cast<size_t>(position)] = voiceGain * panGains[ch];
+
+	auto& env = envelopes[static_cast<size_t>(position)];
+	env.setParameters(params.amp);
+	env.noteOn();
+
+	auto& filterEnv = filterEnvelopes[static_cast<size_t>(position)];
+	filterEnv.setParameters(params.filter.env);
+	filterEnv.noteOn();
+}
+
+void VoiceBank::noteOff(int slot) {
+	const int position = positionOfSlot[static_cast<size_t>(slot)];
+	if (position >= 0) {
+		envelopes[static_cast<size_t>(position)].noteOff();
+		filterEnvelopes[static_cast<size_t>(position)].noteOff();
+	}
+}
+
+void VoiceBank::kill(int slot) {
+	const int position = positionOfSlot[static_cast<size_t>(slot)];
+	if (position >= 0)
+		remove(position);
+}
+
+void VoiceBank::fadeOut(int slot, float seconds) {
+	const int position = positionOfSlot[static_cast<size_t>(slot)];
+	if (position >= 0)
+		envelopes[static_cast<size_t>(position)].fastRelease(seconds);
+}
+
+float VoiceBank::getEnvelopeLevel(int slot) const {
+	const int position = positionOfSlot[static_cast<size_t>(slot)];
+	return position >= 0 ? envelopes[static_cast<size_t>(position)].getLevel() : 0.0f;
+}
+
+AHDSR::State VoiceBank::getEnvelopeState(int slot) const {
+	const int position = positionOfSlot[static_cast<size_t>(slot)];
+	return position >= 0 ? envelopes[static_cast<size_t>(position)].getState() : AHDSR::State::Idle;
+}
+
+void VoiceBank::remove(int position) {
+	const auto pos = static_cast<size_t>(position);
+	const auto last = static_cast<size_t>(--numActive);
+	positionOfSlot[static_cast<size_t>(slotAtPosition[pos])] = -1;
+
+	if (pos != last) {
+		for (int o = 0; o < numOscillators; ++o) {
+			phase[o][pos] = phase[o][last];
+			phaseStep[o][pos] = phaseStep[o][last];
+			phaseInc[o][pos] = phaseInc[o][last];
+			noiseState[o][pos] = noiseState[o][last];
+			noiseFilter[o][pos] = noiseFilter[o][last];
+		}
+		frequency[pos] = frequency[last];
+		for (auto& channelGain : gain)
+			channelGain[pos] = channelGain[last];
+		envelopes[pos] = envelopes[last];
+		filterEnvelopes[pos] = filterEnvelopes[last];
+		filterIc1[pos] = filterIc1[last];
+		filterIc2[pos] = filterIc2[last];
+		filterA1[pos] = filterA1[last];
+		filterA2[pos] = filterA2[last];
+		filterA3[pos] = filterA3[last];
+		filterCutoff[pos] = filterCutoff[last];
+		slotAtPosition[pos] = slotAtPosition[last];
+		positionOfSlot[static_cast<size_t>(slotAtPosition[pos])] = position;
+	}
+
+	// Lanes past the packed range are still rendered as part of the last group; keep them silent.
+	for (auto& channelGain : gain)
+		channelGain[last] = 0.0f;
+	for (int o = 0; o < numOscillators; ++o) {
+		phaseStep[o][last] = 0;
+		phaseInc[o][last] = 0.0f;
+	}
+	filterIc1[last] = filterIc2[last] = 0.0f;
+}
+
+void VoiceBank::removeFinishedVoices() {
+	// Walking backwards, the voice swapped into a freed position has already been checked.
+	for (int position = numActive - 1; position >= 0; --position)
+		if (!envelopes[static_cast<size_t>(position)].isActive())
+			remove(position);
+}
+
+void VoiceBank::updatePhaseIncrements() {
+	const float invSampleRate = static_cast<float>(1.0 / sampleRate);
+
+	for (int o = 0; o < numOscillators; ++o) {
+		const auto& p = params.osc[o];
+		const float fine = juce::jlimit(-100.0f, 100.0f, p.fine);
+		const float ratio = std::exp2((static_cast<float>(p.coarse) * 100.0f + fine) / 1200.0f);
+		const float scale = ratio * invSampleRate;
+		const float offset = juce::jmax(0.0f, p.detune) * invSampleRate;
+
+		auto* step = phaseStep[o].data();
+		auto* inc = phaseInc[o].data();
+		const auto* freq = frequency.data();
+		for (int v = 0; v < numActive; ++v) {
+			const float cycles = freq[v] * scale + offset;
+			step[v] = toFixedPhase(cycles);
+			inc[v] = juce::jmin(cycles, maxPhaseInc);
+		}
+	}
+}
+
+void VoiceBank::render(juce::AudioBuffer<float>& output, int startSample, int numSamples) {
+	if (numActive == 0)
+		return;
+
+	for (int o = 0; o < numOscillators; ++o)
+		levelSmoothed[o].setTargetValue(juce::jlimit(0.0f, 1.0f, params.osc[o].level));
+	for (int v = 0; v < numActive; ++v) {
+		envelopes[static_cast<size_t>(v)].setParameters(params.amp);
+		filterEnvelopes[static_cast<size_t>(v)].setParameters(params.filter.env);
+	}
+	updatePhaseIncrements();
+
+	const auto& filter = params.filter;
+	if (filter.type == VoiceFilter::Off) {
+		std::fill_n(filterIc1.begin(), numActive, 0.0f);
+		std::fill_n(filterIc2.begin(), numActive, 0.0f);
+	} else if (filter.resonance != filterResonance) {
+		// Resonance feeds every coefficient; have each voice recompute on the next update.
+		filterResonance = filter.resonance;
+		filterCutoff.fill(-1.0f);
+	}
+
+	jassert(output.getNumChannels() > 1);
+	auto* left = output.getWritePointer(0, startSample);
+	auto* right = output.getWritePointer(1, startSample);
+
+	for (int offset = 0; offset < numSamples && numActive > 0;) {
+		const int n = juce::jmin(numSamples - offset, subBlockSize);
+
+		// Oscillator levels are shared by all voices and move once per sub-block.
+		std::array<float, numOscillators> levels;
+		for (int o = 0; o < numOscillators; ++o)
+			levels[o] = levelSmoothed[o].skip(n);
+
+		renderEnvelopes(n, offset == 0 || !filter.blockRate);
+
+		for (auto& channelMix : mixAccumulator)
+			for (int i = 0; i < n; ++i)
+				channelMix[i] = Vec::expand(0.0f);
+
+		const int numGroups = (numActive + laneCount - 1) / laneCount;
+		for (int group = 0; group < numGroups; ++group)
+			renderGroup(group, n, levels);
+
+		for (int i = 0; i < n; ++i) {
+			left[offset + i] += mixAccumulator[0][i].sum();
+			right[offset + i] += mixAccumulator[1][i].sum();
+		}
+
+		removeFinishedVoices();
+		offset += n;
+	}
+}
+
+void VoiceBank::renderEnvelopes(int numSamples, bool updateFilter) {
+	float row[subBlockSize];
+	const auto& filter = params.filter;
+
+	for (int v = 0; v < numActive; ++v) {
+		const auto pos = static_cast<size_t>(v);
+		envelopes[pos].renderBlock(row, numSamples);
+
+		float* dest = envelopeBuffer.data() + (v / laneCount) * subBlockSize * laneCount + (v % laneCount);
+		for (int i = 0; i < numSamples; ++i)
+			dest[i * laneCount] = row[i];
+
+		// Coefficients are per voice but only recomputed when the modulated cutoff moves.
+		filterEnvelopes[pos].renderBlock(row, numSamples);
+		if (updateFilter && filter.type != VoiceFilter::Off) {
+			const float cutoff = VoiceFilter::getModulatedCutoff(filter.cutoff, filter.envAmount, row[numSamples - 1]);
+			if (cutoff != filterCutoff[pos]) {
+				const auto c = VoiceFilter::makeCoefficients(sampleRate, cutoff, filter.resonance);
+				filterCutoff[pos] = cutoff;
+				filterA1[pos] = c.a1;
+				filterA2[pos] = c.a2;
+				filterA3[pos] = c.a3;
+				filterK = c.k;
+			}
+		}
+	}
+}
+
+void VoiceBank::renderGroup(int group, int numSamples, const std::array<float, numOscillators>& levels) {
+	Vec* mix = groupMix.data();
+	for (int i = 0; i < numSamples; ++i)
+		mix[i] = Vec::expand(0.0f);
+
+	for (int o = 0; o < numOscillators; ++o)
+		if (levels[o] > 0.0f)
+			renderOscillator(o, group, mix, numSamples, levels[o]);
+
+	switch (params.filter.type) {
+	case VoiceFilter::LowPass:  filterGroup<VoiceFilter::LowPass>(group, numSamples); break;
+	case VoiceFilter::HighPass: filterGroup<VoiceFilter::HighPass>(group, numSamples); break;
+	case VoiceFilter::BandPass: filterGroup<VoiceFilter::BandPass>(group, numSamples); break;
+	default: break;
+	}
+
+	const Vec leftGain = Vec::fromRawArray(gain[0].data() + group * laneCount);
+	const Vec rightGain = Vec::fromRawArray(gain[1].data() + group * laneCount);
+	const float* env = envelopeBuffer.data() + group * subBlockSize * laneCount;
+	for (int i = 0; i < numSamples; ++i) {
+		const Vec voice = mix[i] * Vec::fromRawArray(env + i * laneCount);
+		mixAccumulator[0][i] += voice * leftGain;
+		mixAccumulator[1][i] += voice * rightGain;
+	}
+}
+
+template <VoiceFilter::Type type>
+void VoiceBank::filterGroup(int group, int numSamples) {
+	// The same filter as SynthVoice, one voice per lane with its own state and coefficients.
+	const int base = group * laneCount;
+	Vec ic1 = Vec::fromRawArray(filterIc1.data() + base);
+	Vec ic2 = Vec::fromRawArray(filterIc2.data() + base);
+	const Vec a1 = Vec::fromRawArray(filterA1.data() + base);
+	const Vec a2 = Vec::fromRawArray(filterA2.data() + base);
+	const Vec a3 = Vec::fromRawArray(filterA3.data() + base);
+	const Vec k = Vec::expand(filterK);
+
+	Vec* mix = groupMix.data();
+	for (int i = 0; i < numSamples; ++i)
+		mix[i] = VoiceFilter::tick<type>(mix[i], ic1, ic2, a1, a2, a3, k);
+
+	ic1.copyToRawArray(filterIc1.data() + base);
+	ic2.copyToRawArray(filterIc2.data() + base);
+}
+
+void VoiceBank::renderOscillator(int osc, int group, Vec* dest, int numSamples, float level) {
+	const auto& p = params.osc[osc];
+	juce::uint32* phases = phase[osc].data() + group * laneCount;
+	const juce::uint32* steps = phaseStep[osc].data() + group * laneCount;
+	const float* incs = phaseInc[osc].data() + group * laneCount;
+
+	const Vec inc = Vec::fromRawArray(incs);
+	const float pw = juce::jlimit(0.01f, 0.99f, p.pulseWidth);
+
+	if (p.wave == Oscillator::Noise) {
+		juce::uint32* states = noiseState[osc].data() + group * laneCount;
+		NoiseGenerator::ColourFilter* filters = noiseFilter[osc].data() + group * laneCount;
+		alignas(sizeof(Vec)) float noise[laneCount];
+		for (int i = 0; i < numSamples; ++i) {
+			for (int l = 0; l < laneCount; ++l)
+				noise[l] = filters[l].process(p.noise, NoiseGenerator::toBipolar(NoiseGenerator::step(states[l])));
+			dest[i] += Vec::fromRawArray(noise) * level;
+		}
+		return;
+	}
+
+	if (params.oscQuality == Oscillator::Wavetable && wavetables.isBuilt()) {
+		// Each lane needs its own mip level, so the table reads are gathered lane by lane.
+		const float* tables[laneCount];
+		for (int l = 0; l < laneCount; ++l)
+			tables[l] = wavetables.getTable(p.wave, incs[l]);
+
+		const float shift = 1.0f - pw;
+		const float pulseOffset = 2.0f * pw - 1.0f;
+		const bool isPulse = p.wave == Oscillator::Pulse;
+
+		accumulate(dest, numSamples, phases, steps, level, [&](Vec x) {
+			alignas(sizeof(Vec)) float lanes[laneCount];
+			x.copyToRawArray(lanes);
+			for (int l = 0; l < laneCount; ++l) {
+				const float q = lanes[l];
+				lanes[l] = isPulse
+					? WavetableBank::lookup(tables[l], q) - WavetableBank::lookup(tables[l], q + shift - (q + shift >= 1.0f ? 1.0f : 0.0f)) + pulseOffset
+					: WavetableBank::lookup(tables[l], q);
+			}
+			return Vec::fromRawArray(lanes);
+		});
+		return;
+	}
+
+	alignas(sizeof(Vec)) float invIncs[laneCount];
+	for (int l = 0; l < laneCount; ++l)
+		invIncs[l] = 1.0f / juce::jmax(incs[l], 1.0e-9f);
+	const Vec invDt = Vec::fromRawArray(invIncs);
+	const bool blep = params.oscQuality == Oscillator::PolyBLEP;
+	const Vec one = Vec::expand(1.0f);
+	const Vec pwVec = Vec::expand(pw);
+	const Vec pulseShift = Vec::expand(1.0f - pw);
+	const Vec half = Vec::expand(0.5f);
+
+	// Naive shape plus, for PolyBLEP, the residuals at its discontinuities (see Oscillator::applyPolyBlep).
+	auto run = [&](auto naive, auto residual) {
+		if (blep)
+			accumulate(dest, numSamples, phases, steps, level, [&](Vec x) { return naive(x) + residual(x); });
+		else
+			accumulate(dest, numSamples, phases, steps, level, naive);
+	};
+
+	switch (p.wave) {
+	case Oscillator::Sine:
+		accumulate(dest, numSamples, phases, steps, level, [](Vec x) { return fastSine(x); });
+		break;
+	case Oscillator::Saw:
+		run([&](Vec x) { return one - x * 2.0f; },
+			[&](Vec x) { return vecPolyBlep(x, inc, invDt); });
+		break;
+	case Oscillator::Square:
+		run([&](Vec x) { return vecStep(x, half); },
+			[&](Vec x) { return vecPolyBlep(x, inc, invDt) - vecPolyBlep(vecWrap(x + half), inc, invDt); });
+		break;
+	case Oscillator::Triangle:
+		run([&](Vec x) { return one - vecAbs(x - half) * 4.0f; },
+			[&](Vec x) { return inc * 8.0f * (vecPolyBlamp(x, inc, invDt) - vecPolyBlamp(vecWrap(x + half), inc, invDt)); });
+		break;
+	case Oscillator::Pulse:
+		run([&](Vec x) { return vecStep(x, pwVec); },
+			[&](Vec x) { return vecPolyBlep(x, inc, invDt) - vecPolyBlep(vecWrap(x + pulseShift), inc, invDt); });
+		break;
+	default: jassertfalse; break;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+#include <JuceHeader.h>
+#include "AHDSR.h"
+#include "Oscillator.h"
+#include "VoiceFilter.h"
+#include "WavetableBank.h"
+#include "ParameterSnapshot.h"
+
+// Alternative voice engine that keeps the state of every sounding voice in contiguous
+// per-field arrays and renders them SIMD-width voices at a time. Sounding voices are kept
+// packed at the front of the arrays (a finished voice is swapped with the last one), so
+// every register lane does useful work. SynthVoice stays the juce::SynthesiserVoice front
+// end for note allocation and addresses its voice here by a fixed slot number. Oscillator
+// unison is not implemented here, nor are the mod matrix and MPE: SynthVoice keeps notes
+// that need them to itself. Each voice is panned like SynthVoice's, by its note's voice spread.
+class VoiceBank {
+public:
+	static constexpr int maxVoices = 256;
+
+	VoiceBank(const ParameterSnapshot& params, const WavetableBank& wavetables);
+
+	void prepare(double sampleRate);
+
+	// pan runs from -1 (left) to 1 (right).
+	void noteOn(int slot, float frequency, float velocity, float pan);
+	void noteOff(int slot);
+	void kill(int slot);
+	void fadeOut(int slot, float seconds); // see AHDSR::fastRelease
+	bool isActive(int slot) const { return positionOfSlot[static_cast<size_t>(slot)] >= 0; }
+	int getNumActive() const { return numActive; }
+	AHDSR::State getEnvelopeState(int slot) const;
+	float getEnvelopeLevel(int slot) const;
+
+	// Adds every sounding voice, at its pan, to the synth's stereo voice bus.
+	void render(juce::AudioBuffer<float>& output, int startSample, int numSamples);
+
+	// Equal-power pan gains, scaled so a centred voice has unity gain in both channels.
+	static std::array<float, 2> getPanGains(float pan) {
+		const float angle = (juce::jlimit(-1.0f, 1.0f, pan) + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
+		return { juce::MathConstants<float>::sqrt2 * std::cos(angle), juce::MathConstants<float>::sqrt2 * std::sin(angle) };
+	}
+
+private:
+	using Vec = juce::dsp::SIMDRegister<float>;
+	static constexpr int laneCount = static_cast<int>(Vec::SIMDNumElements);
+	static constexpr int subBlockSize = 32;
+	static constexpr int numOscillators = ParameterSnapshot::numOscillators;
+
+	// Above Nyquist the PolyBLEP residual windows would overlap, so the increments used for
+	// them and for the mip choice are clamped there; the fixed-point steps are not.
+	static constexpr float maxPhaseInc = 0.5f;
+
+	void updatePhaseIncrements();
+	void renderEnvelopes(int numSamples, bool updateFilter);
+	void renderGroup(int group, int numSamples, const std::array<float, numOscillators>& levels);
+	void renderOscillator(int osc, int group, Vec* dest, int numSamples, float level);
+	template <VoiceFilter::Type type>
+	void filterGroup(int group, int numSamples);
+	void remove(int position);
+	void removeFinishedVoices();
+
+	const ParameterSnapshot& params;
+	const WavetableBank& wavetables;
+	double sampleRate = 44100.0;
+	int numActive = 0;
+
+	// Indexed by packed position unless noted otherwise.
+	// Fixed-point phases and steps as in Oscillator; phaseInc is the step in cycles.
+	alignas(64) std::array<std::array<juce::uint32, maxVoices>, numOscillators> phase{};
+	alignas(64) std::array<std::array<juce::uint32, maxVoices>, numOscillators> phaseStep{};
+	alignas(64) std::array<std::array<float, maxVoices>, numOscillators> phaseInc{};
+	alignas(64) std::array<float, maxVoices> frequency{};
+	alignas(64) std::array<std::array<float, maxVoices>, 2> gain{}; // velocity and pan, by channel
+	std::array<AHDSR, maxVoices> envelopes;
+	std::array<AHDSR, maxVoices> filterEnvelopes;
+	alignas(64) std::array<float, maxVoices> filterIc1{};
+	alignas(64) std::array<float, maxVoices> filterIc2{};
+	alignas(64) std::array<float, maxVoices> filterA1{};
+	alignas(64) std::array<float, maxVoices> filterA2{};
+	alignas(64) std::array<float, maxVoices> filterA3{};
+	std::array<float, maxVoices> filterCutoff{}; // modulated cutoff the coefficients were made for
+	std::array<int, maxVoices> slotAtPosition{};
+	std::array<int, maxVoices> positionOfSlot; // by slot, -1 when idle
+
+	// One xorshift stream per voice and oscillator, seeded per note like SynthVoice's.
+	std::array<std::array<juce::uint32, maxVoices>, numOscillators> noiseState{};
+	std::array<std::array<NoiseGenerator::ColourFilter, maxVoices>, numOscillators> noiseFilter{};
+	std::array<juce::uint32, maxVoices> noteCount{}; // by slot
+
+	// Envelope output interleaved as [group][sample][lane] so each sample loads as one register.
+	alignas(64) std::array<float, maxVoices * subBlockSize> envelopeBuffer{};
+	std::array<Vec, subBlockSize> groupMix;
+	std::array<std::array<Vec, subBlockSize>, 2> mixAccumulator;
+
+	std::array<juce::SmoothedValue<float>, numOscillators> levelSmoothed;
+	float filterResonance = -1.0f;
+	float filterK = 2.0f; // depends only on resonance, so shared by every voice
+
+	JUCE_DECLARE_NON_COPYABLE(VoiceBank)
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "VoiceFilter.h"
+
+VoiceFilter::Coefficients VoiceFilter::makeCoefficients(double sampleRate, float cutoffHz, float resonance) {
+	const float nyquistLimit = static_cast<float>(sampleRate * 0.49);
+	const float fc = juce::jlimit(20.0f, nyquistLimit, cutoffHz);
+	const float g = std::tan(juce::MathConstants<float>::pi * fc / static_cast<float>(sampleRate));
+
+	Coefficients c;
+	c.k = 2.0f - 1.96f * juce::jlimit(0.0f, 1.0f, resonance);
+	c.a1 = 1.0f / (1.0f + g * (g + c.k));
+	c.a2 = g * c.a1;
+	c.a3 = g * c.a2;
+	return c;
+}
+
+void VoiceFilter::setSampleRate(double sr) {
+	sampleRate = (sr > 0.0) ? sr : 44100.0;
+	cutoff = -1.0f; // force a recompute at the new rate
+	reset();
+}
+
+void VoiceFilter::reset() {
+	ic1[0] = ic1[1] = 0.0f;
+	ic2[0] = ic2[1] = 0.0f;
+}
+
+void VoiceFilter::setCutoff(float cutoffHz, float res) {
+	if (cutoffHz == cutoff && res == resonance)
+		return;
+	cutoff = cutoffHz;
+	resonance = res;
+	coefficients = makeCoefficients(sampleRate, cutoff, resonance);
+}
+
+void VoiceFilter::process(Type type, float* left, float* right, int numSamples) {
+	switch (type) {
+	case LowPass:
+		processChannel<LowPass>(left, numSamples, ic1[0], ic2[0]);
+		processChannel<LowPass>(right, numSamples, ic1[1], ic2[1]);
+		break;
+	case HighPass:
+		processChannel<HighPass>(left, numSamples, ic1[0], ic2[0]);
+		processChannel<HighPass>(right, numSamples, ic1[1], ic2[1]);
+		break;
+	case BandPass:
+		processChannel<BandPass>(left, numSamples, ic1[0], ic2[0]);
+		processChannel<BandPass>(right, numSamples, ic1[1], ic2[1]);
+		break;
+	default:
+		// Switched off: drop the state so switching back on starts clean.
+		reset();
+		break;
+	}
+}
+
+template <VoiceFilter::Type type>
+void VoiceFilter::processChannel(float* data, int numSamples, float& s1, float& s2) const {
+	// Work on locals so the state stays in registers across the loop.
+	float z1 = s1, z2 = s2;
+	const auto& c = coefficients;
+	for (int i = 0; i < numSamples; ++i)
+		data[i] = tick<type>(data[i], z1, z2, c.a1, c.a2, c.a3, c.k);
+	s1 = z1;
+	s2 = z2;
+}
\ No newline at end of file
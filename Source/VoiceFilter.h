@@ -0,0 +1,60 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Resonant state variable filter in the trapezoidal (topology-preserving) form described by
+// Andrew Simper, so cutoff can move every sub-block without zipper noise or blowing up.
+// The static parts are written for any sample type: SynthVoice runs one VoiceFilter per voice
+// and VoiceBank runs the same tick with one voice per SIMD lane.
+class VoiceFilter {
+public:
+	enum Type { Off, LowPass, HighPass, BandPass };
+
+	struct Coefficients {
+		float a1 = 1.0f;
+		float a2 = 0.0f;
+		float a3 = 0.0f;
+		float k = 2.0f; // 1 / Q
+	};
+
+	// resonance runs from 0 (Q = 0.5) to 1 (Q = 25, just short of self-oscillation).
+	static Coefficients makeCoefficients(double sampleRate, float cutoffHz, float resonance);
+
+	// Cutoff moved by envAmount octaves at full envelope level.
+	static float getModulatedCutoff(float cutoffHz, float envAmount, float envLevel) {
+		return cutoffHz * std::exp2(envAmount * envLevel);
+	}
+
+	// One sample through the filter. Band-pass is scaled by k so its peak stays at unity.
+	template <Type type, typename T>
+	static T tick(T in, T& ic1, T& ic2, T a1, T a2, T a3, T k) {
+		const T v3 = in - ic2;
+		const T v1 = a1 * ic1 + a2 * v3;
+		const T v2 = ic2 + a2 * ic1 + a3 * v3;
+		ic1 = v1 * 2.0f - ic1;
+		ic2 = v2 * 2.0f - ic2;
+
+		if constexpr (type == HighPass)
+			return in - k * v1 - v2;
+		else if constexpr (type == BandPass)
+			return k * v1;
+		else
+			return v2;
+	}
+
+	void setSampleRate(double sr);
+	void reset();
+	// Only recomputes the coefficients when cutoff or resonance differ from the previous call.
+	void setCutoff(float cutoffHz, float resonance);
+	void process(Type type, float* left, float* right, int numSamples);
+
+private:
+	template <Type type>
+	void processChannel(float* data, int numSamples, float& ic1, float& ic2) const;
+
+	double sampleRate{ 44100.0 };
+	float  cutoff{ -1.0f };
+	float  resonance{ -1.0f };
+	Coefficients coefficients;
+	float  ic1[2]{};
+	float  ic2[2]{};
+};
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "VoiceRenderPool.h"
+
+class VoiceRenderPool::Worker : public juce::Thread {
+public:
+	Worker(VoiceRenderPool& p, int lane)
+		: juce::Thread("Cyqnus voice worker " + juce::String(lane)), pool(p), laneIndex(lane) {}
+
+	~Worker() override {
+		signalThreadShouldExit();
+		wake.signal();
+		stopThread(2000);
+	}
+
+	void start() {
+		startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(10));
+	}
+
+	void trigger() {
+		wake.signal();
+	}
+
+	void run() override {
+		while (!threadShouldExit()) {
+			if (!wake.wait(100.0))
+				continue;
+			if (threadShouldExit())
+				break;
+
+			pool.runLane(laneIndex);
+			pool.pendingWorkers.fetch_sub(1, std::memory_order_acq_rel);
+		}
+	}
+
+private:
+	VoiceRenderPool& pool;
+	const int laneIndex;
+	juce::WaitableEvent wake;
+};
+
+VoiceRenderPool::VoiceRenderPool() {}
+
+VoiceRenderPool::~VoiceRenderPool() {
+	release();
+}
+
+void VoiceRenderPool::prepare(int numWorkerThreads, int numChannels, int maxBlockSize) {
+	release();
+
+	maxSamples = juce::jmax(1, maxBlockSize);
+	for (int i = 0; i <= numWorkerThreads; ++i) {
+		lanes.push_back(std::make_unique<Lane>());
+		lanes.back()->scratch.setSize(juce::jmax(1, numChannels), maxSamples);
+	}
+
+	for (int i = 1; i <= numWorkerThreads; ++i) {
+		workers.push_back(std::make_unique<Worker>(*this, i));
+		workers.back()->start();
+	}
+}
+
+void VoiceRenderPool::release() {
+	workers.clear();
+	lanes.clear();
+	maxSamples = 0;
+}
+
+void VoiceRenderPool::render(juce::SynthesiserVoice* const* voices, int numVoices,
+	juce::AudioBuffer<float>& output, int startSample, int numSamples) {
+	jassert(canRender(numSamples));
+
+	const int numLanes = static_cast<int>(lanes.size());
+	jobVoices = voices;
+	jobNumSamples = numSamples;
+
+	for (int i = 0; i < numLanes; ++i) {
+		auto& lane = *lanes[i];
+		lane.next.store(i * numVoices / numLanes, std::memory_order_relaxed);
+		lane.end = (i + 1) * numVoices / numLanes;
+		lane.used = false;
+	}
+
+	// WaitableEvent::signal() publishes the job set up above to the workers.
+	pendingWorkers.store(static_cast<int>(workers.size()), std::memory_order_relaxed);
+	for (auto& worker : workers)
+		worker->trigger();
+
+	runLane(0);
+
+	while (pendingWorkers.load(std::memory_order_acquire) > 0)
+		juce::Thread::yield();
+
+	const int numChannels = juce::jmin(output.getNumChannels(), lanes[0]->scratch.getNumChannels());
+	for (auto& lane : lanes) {
+		if (!lane->used)
+			continue;
+		for (int ch = 0; ch < numChannels; ++ch)
+			output.addFrom(ch, startSample, lane->scratch, ch, 0, numSamples);
+	}
+}
+
+void VoiceRenderPool::runLane(int laneIndex) {
+	const int numLanes = static_cast<int>(lanes.size());
+	auto& own = *lanes[laneIndex];
+
+	for (int i = 0; i < numLanes; ++i)
+		renderFrom(own, *lanes[(laneIndex + i) % numLanes]);
+}
+
+void VoiceRenderPool::renderFrom(Lane& own, Lane& source) {
+	for (;;) {
+		const int index = source.next.fetch_add(1, std::memory_order_relaxed);
+		if (index >= source.end)
+			return;
+
+		if (!own.used) {
+			own.scratch.clear(0, jobNumSamples);
+			own.used = true;
+		}
+		jobVoices[index]->renderNextBlock(own.scratch, 0, jobNumSamples);
+	}
+}
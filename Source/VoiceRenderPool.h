@@ -0,0 +1,47 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Fixed pool of realtime worker threads that render synth voices in parallel.
+// The calling (audio) thread works as lane 0. Voices are split into one contiguous
+// range per lane, and a lane that runs out of work steals from the others through the
+// same atomic cursors. Each lane renders into its own scratch buffer, and the caller
+// sums those at the end, so voices never write to the host buffer concurrently.
+class VoiceRenderPool {
+public:
+	VoiceRenderPool();
+	~VoiceRenderPool();
+
+	// Message thread only: (re)creates the workers and scratch buffers.
+	void prepare(int numWorkerThreads, int numChannels, int maxBlockSize);
+	void release();
+
+	int getNumWorkers() const { return static_cast<int>(workers.size()); }
+	bool canRender(int numSamples) const { return !workers.empty() && numSamples <= maxSamples; }
+
+	// Audio thread only. Blocks until every voice has been rendered and summed into output.
+	void render(juce::SynthesiserVoice* const* voices, int numVoices,
+		juce::AudioBuffer<float>& output, int startSample, int numSamples);
+
+private:
+	class Worker;
+
+	struct alignas(64) Lane {
+		std::atomic<int> next{ 0 };
+		int end = 0;
+		bool used = false;
+		juce::AudioBuffer<float> scratch;
+	};
+
+	void runLane(int laneIndex);
+	void renderFrom(Lane& own, Lane& source);
+
+	std::vector<std::unique_ptr<Lane>> lanes;
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::atomic<int> pendingWorkers{ 0 };
+	int maxSamples = 0;
+
+	juce::SynthesiserVoice* const* jobVoices = nullptr;
+	int jobNumSamples = 0;
+
+	JUCE_DECLARE_NON_COPYABLE(VoiceRenderPool)
+};
@@ -0,0 +1,86 @@
+#include "WavetableBank.h"
+
+void WavetableBank::build() {
+	if (built)
+		return;
+
+	sineTable.assign(stride, 0.0f);
+	for (int i = 0; i < tableSize; ++i)
+		sineTable[i] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * i / tableSize));
+	sineTable[tableSize] = sineTable[0];
+
+	tables.assign(static_cast<size_t>(numShapes * numLevels * stride), 0.0f);
+
+	const float pi = juce::MathConstants<float>::pi;
+	auto none = [](int) { return 0.0f; };
+	auto oddOnly = [](int h, float amp) { return (h & 1) ? amp : 0.0f; };
+
+	for (int level = 0; level < numLevels; ++level) {
+		const int numHarmonics = (tableSize / 2) >> level;
+
+		// 1 - 2p
+		fillTable(getTableForWrite(SawShape, level), numHarmonics,
+			[pi](int h) { return 2.0f / (pi * h); }, none);
+		// +1 for p < 0.5, -1 otherwise
+		fillTable(getTableForWrite(SquareShape, level), numHarmonics,
+			[pi, oddOnly](int h) { return oddOnly(h, 4.0f / (pi * h)); }, none);
+		// 1 - 4|p - 0.5|
+		fillTable(getTableForWrite(TriangleShape, level), numHarmonics,
+			none, [pi, oddOnly](int h) { return oddOnly(h, -8.0f / (pi * pi * h * h)); });
+	}
+
+	built = true;
+}
+
+bool WavetableBank::isBuilt() const {
+	return built;
+}
+
+const float* WavetableBank::getTable(Oscillator::Waveform wf, float phaseInc) const {
+	jassert(built);
+
+	switch (wf) {
+	case Oscillator::Sine:     return sineTable.data();
+	case Oscillator::Saw:
+	case Oscillator::Pulse:    return tables.data() + (SawShape * numLevels + getLevel(phaseInc)) * stride;
+	case Oscillator::Square:   return tables.data() + (SquareShape * numLevels + getLevel(phaseInc)) * stride;
+	case Oscillator::Triangle: return tables.data() + (TriangleShape * numLevels + getLevel(phaseInc)) * stride;
+	default: jassertfalse; return sineTable.data();
+	}
+}
+
+int WavetableBank::getLevel(float phaseInc) {
+	// Smallest level with 2^level >= phaseInc * tableSize.
+	const float cyclesPerTable = phaseInc * static_cast<float>(tableSize);
+	if (cyclesPerTable <= 1.0f)
+		return 0;
+
+	int exponent = 0;
+	const float mantissa = std::frexp(cyclesPerTable, &exponent);
+	const int level = (mantissa == 0.5f) ? exponent - 1 : exponent;
+	return juce::jmin(level, numLevels - 1);
+}
+
+float* WavetableBank::getTableForWrite(int shape, int level) {
+	return tables.data() + (shape * numLevels + level) * stride;
+}
+
+void WavetableBank::fillTable(float* dest, int numHarmonics,
+	const std::function<float(int)>& sineAmp, const std::function<float(int)>& cosineAmp) {
+	// Additive synthesis from the fundamental sine table; (h * i) mod tableSize indexes it exactly.
+	const int quarter = tableSize / 4;
+	const int mask = tableSize - 1;
+
+	for (int h = 1; h <= numHarmonics; ++h) {
+		const float s = sineAmp(h);
+		const float c = cosineAmp(h);
+		if (s == 0.0f && c == 0.0f)
+			continue;
+
+		for (int i = 0; i < tableSize; ++i) {
+			const int index = (h * i) & mask;
+			dest[i] += s * sineTable[index] + c * sineTable[(index + quarter) & mask];
+		}
+	}
+	dest[tableSize] = dest[0];
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Oscillator.h"
+
+// Immutable set of band-limited single-cycle tables shared by every oscillator.
+// Each waveform has one table per octave of phase increment; table `level` holds
+// (tableSize / 2) >> level harmonics, so a lookup stays alias-free up to
+// phaseInc = 2^level / tableSize. The tables depend only on the phase increment,
+// not on the sample rate, so one bank serves any rate.
+class WavetableBank {
+public:
+	static constexpr int tableBits = 11;
+	static constexpr int tableSize = 1 << tableBits;
+	static constexpr int numLevels = 11;
+
+	void build();
+	bool isBuilt() const;
+
+	// Pulse shares the Saw tables (see Oscillator::renderFromTable); Noise has no table.
+	const float* getTable(Oscillator::Waveform wf, float phaseInc) const;
+
+	static float lookup(const float* table, float phase) {
+		const float pos = phase * static_cast<float>(tableSize);
+		const int index = static_cast<int>(pos);
+		const float frac = pos - static_cast<float>(index);
+		return table[index] + frac * (table[index + 1] - table[index]);
+	}
+
+	// Same for a fixed-point phase (2^32 per cycle): the top tableBits bits are the index and
+	// the rest the interpolation fraction, so there is no multiply, truncation or wrap.
+	static float lookup(const float* table, juce::uint32 phase) {
+		constexpr int fracBits = 32 - tableBits;
+		const auto index = static_cast<int>(phase >> fracBits);
+		const float frac = static_cast<float>(phase & ((1u << fracBits) - 1u)) * (1.0f / static_cast<float>(1u << fracBits));
+		return table[index] + frac * (table[index + 1] - table[index]);
+	}
+
+private:
+	enum Shape { SawShape, SquareShape, TriangleShape, numShapes };
+	static constexpr int stride = tableSize + 1; // one guard sample for interpolation
+
+	static int getLevel(float phaseInc);
+	float* getTableForWrite(int shape, int level);
+	void fillTable(float* dest, int numHarmonics, const std::function<float(int)>& sineAmp, const std::function<float(int)>& cosineAmp);
+
+	std::vector<float> sineTable;
+	std::vector<float> tables; // [shape][level][stride]
+	bool built = false;
+};
@@ -0,0 +1,513 @@
+/*
+  ==============================================================================
+
+    Micro and macro benchmarks for the DSP hot paths. Every case is timed at each
+    requested sample rate and block size and the results are written as JSON so
+    runs from different builds can be diffed.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/RealtimeCheck.h"
+
+//==============================================================================
+struct BenchOptions
+{
+    juce::Array<double> sampleRates{ 44100.0, 48000.0, 96000.0 };
+    juce::Array<int> blockSizes{ 64, 256, 1024 };
+    juce::Array<int> voiceCounts{ 1, 8, 64 };
+    double secondsPerCase = 0.1;
+    int unison = 1;
+    juce::String filter;
+    juce::File output;
+};
+
+struct BenchCase
+{
+    juce::String benchmark;
+    juce::String variant;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int voices = 1;
+};
+
+static void printUsage()
+{
+    std::cout << "Usage: CyqnusBench [options]\n"
+                 "  --out=<file.json>      write results to a file instead of stdout\n"
+                 "  --rates=<hz,...>       sample rates (default: 44100,48000,96000)\n"
+                 "  --blocks=<n,...>       block sizes (default: 64,256,1024)\n"
+                 "  --voices=<n,...>       held voices for the processBlock and render pool cases (default: 1,8,64)\n"
+                 "  --seconds=<s>          minimum timed duration per case (default: 0.1)\n"
+                 "  --filter=<text>        only run benchmarks whose name contains <text>\n"
+                 "  --unison=<n>           unison copies per oscillator for the processBlock and render pool cases (default: 1)\n"
+                 "  --check-realtime       instead of benchmarking, play processBlock through every engine mode at\n"
+                 "                         32-sample blocks and fail if it allocated (RealtimeCheck configuration only)\n";
+}
+
+// Keeps the optimiser from discarding the rendered samples.
+static volatile float benchSink = 0.0f;
+
+// Calls renderBlock (which must render exactly blockSize samples) until at least
+// secondsPerCase have elapsed and returns the average cost per sample in ns.
+template <typename RenderBlock>
+static double measureNsPerSample(const BenchOptions& options, int blockSize, RenderBlock&& renderBlock)
+{
+    renderBlock(); // warm caches, tables and branch predictors
+
+    const auto minTicks = static_cast<juce::int64>(options.secondsPerCase * juce::Time::getHighResolutionTicksPerSecond());
+    const auto start = juce::Time::getHighResolutionTicks();
+    juce::int64 elapsed = 0;
+    juce::int64 numSamples = 0;
+
+    do
+    {
+        renderBlock();
+        numSamples += blockSize;
+        elapsed = juce::Time::getHighResolutionTicks() - start;
+    } while (elapsed < minTicks);
+
+    return juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e9 / static_cast<double>(numSamples);
+}
+
+class BenchRunner
+{
+public:
+    explicit BenchRunner(const BenchOptions& o) : options(o) {}
+
+    bool wants(const juce::String& benchmark) const
+    {
+        return options.filter.isEmpty() || benchmark.containsIgnoreCase(options.filter);
+    }
+
+    template <typename RenderBlock>
+    void run(const BenchCase& c, RenderBlock&& renderBlock)
+    {
+        const double nsPerSample = measureNsPerSample(options, c.blockSize, renderBlock);
+
+        // How many instances of this workload one core could keep running in real time.
+        const double voicesPerCore = c.voices * 1.0e9 / (nsPerSample * c.sampleRate);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("benchmark", c.benchmark);
+        result->setProperty("variant", c.variant);
+        result->setProperty("sampleRate", c.sampleRate);
+        result->setProperty("blockSize", c.blockSize);
+        result->setProperty("voices", c.voices);
+        result->setProperty("nsPerSample", nsPerSample);
+        result->setProperty("voicesPerCore", voicesPerCore);
+        results.add(juce::var(result));
+
+        std::cerr << c.benchmark << " [" << c.variant << "] " << c.sampleRate << " Hz / " << c.blockSize << ": "
+                  << juce::String(nsPerSample, 2) << " ns/sample" << std::endl;
+    }
+
+    juce::var toJson() const
+    {
+        auto* machine = new juce::DynamicObject();
+        machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+        machine->setProperty("logicalCpus", juce::SystemStats::getNumCpus());
+        machine->setProperty("physicalCpus", juce::SystemStats::getNumPhysicalCpus());
+        machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+        root->setProperty("juce", juce::SystemStats::getJUCEVersion());
+       #if JUCE_DEBUG
+        root->setProperty("build", "Debug");
+       #else
+        root->setProperty("build", "Release");
+       #endif
+        root->setProperty("machine", juce::var(machine));
+        root->setProperty("secondsPerCase", options.secondsPerCase);
+        root->setProperty("unison", options.unison);
+        root->setProperty("results", results);
+        return juce::var(root);
+    }
+
+private:
+    const BenchOptions& options;
+    juce::Array<juce::var> results;
+};
+
+//==============================================================================
+static const char* const waveformNames[] = { "Sine", "Saw", "Square", "Triangle", "Pulse", "Noise" };
+static const char* const qualityNames[] = { "Naive", "PolyBLEP", "Wavetable" };
+static const char* const stageNames[] = { "Attack", "Hold", "Decay", "Sustain", "Release" };
+static const char* const curveNames[] = { "Linear", "Exponential" };
+
+static void benchOscillator(BenchRunner& runner, const BenchOptions& options, const WavetableBank& wavetables)
+{
+    const juce::String name = "Oscillator::getNextSample";
+    if (!runner.wants(name))
+        return;
+
+    for (int q = 0; q < juce::numElementsInArray(qualityNames); ++q)
+        for (int w = 0; w < juce::numElementsInArray(waveformNames); ++w)
+            for (auto sampleRate : options.sampleRates)
+                for (auto blockSize : options.blockSizes)
+                {
+                    Oscillator osc;
+                    osc.setSampleRate(sampleRate);
+                    osc.setWavetableBank(&wavetables);
+                    osc.setQuality(static_cast<Oscillator::Quality>(q));
+                    osc.setWaveform(static_cast<Oscillator::Waveform>(w));
+                    osc.setFrequency(440.0f);
+                    osc.setLevel(0.8f);
+                    osc.skipSmoothing();
+
+                    runner.run({ name, juce::String(waveformNames[w]) + "/" + qualityNames[q], sampleRate, blockSize }, [&]
+                    {
+                        float sum = 0.0f;
+                        for (int i = 0; i < blockSize; ++i)
+                            sum += osc.getNextSample();
+                        benchSink = sum;
+                    });
+                }
+}
+
+// Every stage except the one under test is made near-instant, the one under test
+// is made long enough to outlast the measurement.
+static AHDSR::Params envelopeParamsFor(int stage, int curve)
+{
+    constexpr float instant = 1.0e-4f;
+    constexpr float forever = 1.0e4f;
+
+    AHDSR::Params p;
+    p.attack = stage == 0 ? forever : instant;
+    p.hold = stage == 1 ? forever : instant;
+    p.decay = stage == 2 ? forever : instant;
+    p.sustain = 0.5f;
+    p.release = stage == 4 ? forever : instant;
+    p.curve = static_cast<AHDSR::Curve>(curve);
+    return p;
+}
+
+template <typename RenderBlock>
+static void benchEnvelope(BenchRunner& runner, const BenchOptions& options, const juce::String& name, RenderBlock&& renderBlock)
+{
+    if (!runner.wants(name))
+        return;
+
+    std::vector<float> scratch(static_cast<size_t>(options.blockSizes.isEmpty() ? 0 : *std::max_element(options.blockSizes.begin(), options.blockSizes.end())));
+
+    for (int curve = 0; curve < juce::numElementsInArray(curveNames); ++curve)
+        for (int stage = 0; stage < juce::numElementsInArray(stageNames); ++stage)
+            for (auto sampleRate : options.sampleRates)
+                for (auto blockSize : options.blockSizes)
+                {
+                    AHDSR env;
+                    env.setSampleRate(sampleRate);
+                    env.setParameters(envelopeParamsFor(stage, curve));
+                    env.noteOn();
+
+                    // Step past the instant stages so the timed loop only sees the one under test.
+                    for (int i = 0, skip = juce::roundToInt(sampleRate * 0.001) + 8; i < skip; ++i)
+                        env.getNextSample();
+                    if (stage == 4)
+                        env.noteOff();
+
+                    runner.run({ name, juce::String(stageNames[stage]) + "/" + curveNames[curve], sampleRate, blockSize }, [&]
+                    {
+                        benchSink = renderBlock(env, scratch.data(), blockSize);
+                    });
+                }
+}
+
+static void benchEnvelopes(BenchRunner& runner, const BenchOptions& options)
+{
+    benchEnvelope(runner, options, "AHDSR::getNextSample", [](AHDSR& env, float*, int numSamples)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < numSamples; ++i)
+            sum += env.getNextSample();
+        return sum;
+    });
+
+    benchEnvelope(runner, options, "AHDSR::renderBlock", [](AHDSR& env, float* dest, int numSamples)
+    {
+        env.renderBlock(dest, numSamples);
+        return dest[numSamples - 1];
+    });
+}
+
+static void benchVoice(BenchRunner& runner, const BenchOptions& options, const WavetableBank& wavetables)
+{
+    const juce::String name = "SynthVoice::renderNextBlock";
+    if (!runner.wants(name))
+        return;
+
+    ParameterSnapshot params;
+    SynthSound sound;
+
+    for (auto sampleRate : options.sampleRates)
+        for (auto blockSize : options.blockSizes)
+        {
+            VoiceBank voiceBank(params, wavetables);
+            SynthVoice voice(params, wavetables, voiceBank, 0);
+            voice.setCurrentPlaybackSampleRate(sampleRate);
+            voice.prepareToPlay(sampleRate, blockSize);
+            voice.startNote(60, 1.0f, &sound, 8192);
+
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            runner.run({ name, "default", sampleRate, blockSize }, [&]
+            {
+                buffer.clear();
+                voice.renderNextBlock(buffer, 0, blockSize);
+                benchSink = buffer.getSample(0, blockSize - 1);
+            });
+        }
+}
+
+static void setParameter(CyqnusAudioProcessor& processor, const juce::String& id, float value)
+{
+    if (auto* parameter = processor.apvts.getParameter(id))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+static void benchProcessor(BenchRunner& runner, const BenchOptions& options)
+{
+    const juce::String name = "CyqnusAudioProcessor::processBlock";
+    if (!runner.wants(name))
+        return;
+
+    for (const bool useVoiceBank : { false, true })
+        for (auto numVoices : options.voiceCounts)
+            for (auto sampleRate : options.sampleRates)
+                for (auto blockSize : options.blockSizes)
+                {
+                    // Offline, so the user's preset bank and the render pool stay out of the numbers.
+                    CyqnusAudioProcessor processor(true);
+                    setParameter(processor, "polyphony", static_cast<float>(numVoices));
+                    setParameter(processor, "voiceBank", useVoiceBank ? 1.0f : 0.0f);
+                    for (int osc = 1; osc <= ParameterSnapshot::numOscillators; ++osc)
+                        setParameter(processor, "osc" + juce::String(osc) + "Unison", static_cast<float>(options.unison));
+
+                    const int numChannels = processor.getTotalNumOutputChannels();
+                    processor.setPlayConfigDetails(0, numChannels, sampleRate, blockSize);
+                    processor.prepareToPlay(sampleRate, blockSize);
+
+                    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+                    juce::MidiBuffer midi;
+                    for (int i = 0; i < numVoices; ++i)
+                        midi.addEvent(juce::MidiMessage::noteOn(1, 24 + i % 96, 0.8f), 0);
+                    processor.processBlock(buffer, midi);
+                    midi.clear();
+
+                    const auto variant = juce::String(numVoices) + " voices/" + (useVoiceBank ? "bank" : "per-voice");
+                    runner.run({ name, variant, sampleRate, blockSize, numVoices }, [&]
+                    {
+                        processor.processBlock(buffer, midi);
+                        benchSink = buffer.getSample(0, blockSize - 1);
+                    });
+
+                    processor.releaseResources();
+                }
+}
+
+// The parallel render pool against the serial voice loop, on a synth built like the
+// processor's. Below CyqnusSynthesiser's minimum the parallel case renders serially too.
+static void benchRenderPool(BenchRunner& runner, const BenchOptions& options, const WavetableBank& wavetables)
+{
+    const juce::String name = "CyqnusSynthesiser::renderNextBlock";
+    if (!runner.wants(name))
+        return;
+
+    for (const bool parallel : { false, true })
+        for (auto numVoices : options.voiceCounts)
+            for (auto sampleRate : options.sampleRates)
+                for (auto blockSize : options.blockSizes)
+                {
+                    ParameterSnapshot params;
+                    for (auto& osc : params.osc)
+                        osc.unison = options.unison;
+
+                    VoiceBank voiceBank(params, wavetables);
+                    voiceBank.prepare(sampleRate);
+
+                    CyqnusSynthesiser synth;
+                    for (int i = 0; i < CyqnusSynthesiser::maxVoices; ++i)
+                    {
+                        auto* voice = new SynthVoice(params, wavetables, voiceBank, i);
+                        voice->setChannelStates(synth.getChannelStates());
+                        voice->prepareToPlay(sampleRate, blockSize);
+                        synth.addVoice(voice);
+                    }
+                    synth.addSound(new SynthSound());
+                    synth.setVoiceBank(&voiceBank);
+                    synth.prepare(sampleRate, blockSize);
+                    synth.setPolyphony(numVoices);
+                    synth.setParallelRendering(parallel);
+                    if (parallel)
+                        synth.prepareRenderPool();
+
+                    for (int i = 0; i < numVoices; ++i)
+                        synth.noteOn(1, 24 + i % 96, 0.8f);
+
+                    juce::AudioBuffer<float> buffer(2, blockSize);
+                    juce::MidiBuffer midi;
+                    const auto variant = juce::String(numVoices) + " voices/" + (parallel ? "parallel" : "serial");
+                    runner.run({ name, variant, sampleRate, blockSize, numVoices }, [&]
+                    {
+                        buffer.clear();
+                        synth.renderNextBlock(buffer, midi, 0, blockSize);
+                        benchSink = buffer.getSample(0, blockSize - 1);
+                    });
+
+                    synth.releaseRenderPool();
+                }
+}
+
+// Plays notes, controllers, pedals and steals through processBlock at 32-sample blocks
+// for each oversampling order with and without the voice bank, MPE and modulation routes,
+// with the odd block longer than announced. Any allocation inside processBlock is counted
+// by RealtimeCheck; returns the process exit code.
+static int checkRealtimeAllocations()
+{
+   #if ! CYQNUS_CHECK_REALTIME_ALLOCATIONS
+    std::cerr << "--check-realtime needs a build with CYQNUS_CHECK_REALTIME_ALLOCATIONS=1 (the RealtimeCheck configuration)" << std::endl;
+    return 1;
+   #else
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 32;
+    constexpr int blocksPerMode = 1500;
+
+    CyqnusAudioProcessor processor(true);
+    const int numChannels = processor.getTotalNumOutputChannels();
+    processor.setPlayConfigDetails(0, numChannels, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // Fewer voices than notes, so notes get stolen.
+    setParameter(processor, "polyphony", 12.0f);
+    setParameter(processor, "osc1Unison", 4.0f);
+    setParameter(processor, "voiceSpread", 0.5f);
+    setParameter(processor, "filterType", 1.0f);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize * 4);
+    juce::MidiBuffer midi;
+    juce::int64 block = 0;
+
+    for (int order = 0; order <= 3; ++order)
+        for (int mode = 0; mode < 8; ++mode)
+        {
+            const bool useVoiceBank = (mode & 1) != 0;
+            const bool useMpe = (mode & 2) != 0;
+            const bool useRoutes = (mode & 4) != 0;
+            setParameter(processor, "oversampling", static_cast<float>(order));
+            setParameter(processor, "voiceBank", useVoiceBank ? 1.0f : 0.0f);
+            setParameter(processor, "mpe", useMpe ? 1.0f : 0.0f);
+            setParameter(processor, "mod1Source", useRoutes ? 1.0f : 0.0f); // LFO 1
+            setParameter(processor, "mod1Dest", 0.0f);                      // Osc 1 Pitch
+            setParameter(processor, "mod1Amount", 0.1f);
+            setParameter(processor, "mod2Source", useRoutes ? 3.0f : 0.0f); // Mod Env
+            setParameter(processor, "mod2Dest", 12.0f);                     // Voice Pan
+            setParameter(processor, "mod2Amount", 0.5f);
+
+            for (int i = 0; i < blocksPerMode; ++i, ++block)
+            {
+                const int numSamples = block % 64 == 63 ? blockSize * 3 + 5 : blockSize;
+                // A note starts every 8 blocks and is held for 125, about 15 at a time.
+                auto channelAt = [useMpe](juce::int64 b) { return useMpe ? 2 + static_cast<int>(b / 8 % 15) : 1; };
+                auto noteAt = [](juce::int64 b) { return 36 + static_cast<int>(b * 7 % 48); };
+                const int channel = channelAt(block);
+
+                midi.clear();
+                if (block % 8 == 0)
+                    midi.addEvent(juce::MidiMessage::noteOn(channel, noteAt(block), 0.8f), 0);
+                if (block >= 125 && block % 8 == 5)
+                    midi.addEvent(juce::MidiMessage::noteOff(channelAt(block - 125), noteAt(block - 125)), 3);
+                if (block % 3 == 0)
+                {
+                    const int value = static_cast<int>(block % 128);
+                    midi.addEvent(juce::MidiMessage::pitchWheel(channel, value * 128), 1);
+                    midi.addEvent(juce::MidiMessage::controllerEvent(channel, 1, value), 2);
+                    midi.addEvent(juce::MidiMessage::controllerEvent(channel, 74, 127 - value), 2);
+                    midi.addEvent(juce::MidiMessage::channelPressureChange(channel, value), 4);
+                }
+                if (block % 200 == 0)
+                    midi.addEvent(juce::MidiMessage::controllerEvent(1, 64, block % 400 == 0 ? 127 : 0), 6);
+
+                buffer.setSize(numChannels, numSamples, false, false, true);
+                processor.processBlock(buffer, midi);
+                benchSink = buffer.getSample(0, numSamples - 1);
+            }
+
+            midi.clear();
+            midi.addEvent(juce::MidiMessage::allNotesOff(1), 0);
+            buffer.setSize(numChannels, blockSize, false, false, true);
+            processor.processBlock(buffer, midi);
+        }
+
+    processor.releaseResources();
+
+    const int numViolations = RealtimeCheck::getNumViolations();
+    std::cout << block << " blocks, " << numViolations << " allocations inside processBlock" << std::endl;
+    return numViolations == 0 ? 0 : 1;
+   #endif
+}
+
+//==============================================================================
+template <typename T>
+static juce::Array<T> parseList(const juce::String& text)
+{
+    juce::Array<T> values;
+    for (const auto& token : juce::StringArray::fromTokens(text, ",", {}))
+        if (const auto value = static_cast<T>(token.getDoubleValue()); value > 0)
+            values.add(value);
+    return values;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    if (args.containsOption("--check-realtime"))
+        return checkRealtimeAllocations();
+
+    BenchOptions options;
+    if (args.containsOption("--out"))     options.output = args.getFileForOption("--out");
+    if (args.containsOption("--rates"))   options.sampleRates = parseList<double>(args.getValueForOption("--rates"));
+    if (args.containsOption("--blocks"))  options.blockSizes = parseList<int>(args.getValueForOption("--blocks"));
+    if (args.containsOption("--voices"))  options.voiceCounts = parseList<int>(args.getValueForOption("--voices"));
+    if (args.containsOption("--seconds")) options.secondsPerCase = args.getValueForOption("--seconds").getDoubleValue();
+    if (args.containsOption("--filter"))  options.filter = args.getValueForOption("--filter");
+    if (args.containsOption("--unison"))  options.unison = juce::jlimit(1, Oscillator::maxUnison, args.getValueForOption("--unison").getIntValue());
+
+    if (options.sampleRates.isEmpty() || options.blockSizes.isEmpty() || options.voiceCounts.isEmpty() || options.secondsPerCase <= 0.0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    WavetableBank wavetables;
+    wavetables.build();
+
+    BenchRunner runner(options);
+    benchOscillator(runner, options, wavetables);
+    benchEnvelopes(runner, options);
+    benchVoice(runner, options, wavetables);
+    benchProcessor(runner, options);
+    benchRenderPool(runner, options, wavetables);
+
+    const auto json = juce::JSON::toString(runner.toJson());
+    if (options.output == juce::File())
+    {
+        std::cout << json << std::endl;
+    }
+    else if (!options.output.replaceWithText(json))
+    {
+        std::cerr << "Could not write " << options.output.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,284 @@
+/*
+  ==============================================================================
+
+    Headless offline renderer: drives CyqnusAudioProcessor from Standard MIDI
+    Files and writes the result to WAV or FLAC, without an editor or audio device.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+//==============================================================================
+struct RenderOptions
+{
+    juce::File preset;
+    juce::File outputDir;
+    juce::String format = "wav";
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    int bitDepth = 24;
+    double tailSeconds = 2.0;
+    int numJobs = 1;
+    bool writeStats = false;
+};
+
+static void printUsage()
+{
+    std::cout << "Usage: CyqnusRender [options] <input.mid> [<input.mid> ...]\n"
+                 "       CyqnusRender --make-bank=<bank.cyqbank> <preset> [<preset> ...]\n"
+                 "  --preset=<state>       plugin state as written by getStateInformation (binary or older XML)\n"
+                 "  --out-dir=<dir>        output directory (default: next to each input)\n"
+                 "  --format=wav|flac      output format (default: wav)\n"
+                 "  --rate=<hz>            sample rate (default: 48000)\n"
+                 "  --block=<samples>      processBlock size (default: 512)\n"
+                 "  --bits=<16|24|32>      bit depth (default: 24; flac max 24)\n"
+                 "  --tail=<seconds>       maximum render time after the last MIDI event, stops early\n"
+                 "                         once the output is silent (default: 2)\n"
+                 "  --jobs=<n>             files rendered in parallel (default: 1, 0 = one per core)\n"
+                 "  --stats                also write <output>.stats.json with processBlock and voice\n"
+                 "                         render times as a share of the realtime budget\n";
+}
+
+static juce::Result loadMidi(const juce::File& file, juce::MidiMessageSequence& sequence)
+{
+    juce::FileInputStream stream(file);
+    juce::MidiFile midiFile;
+    if (!stream.openedOk() || !midiFile.readFrom(stream))
+        return juce::Result::fail("Could not read MIDI file " + file.getFullPathName());
+
+    midiFile.convertTimestampTicksToSeconds();
+    for (int track = 0; track < midiFile.getNumTracks(); ++track)
+        sequence.addSequence(*midiFile.getTrack(track), 0.0);
+    sequence.sort();
+    return juce::Result::ok();
+}
+
+static std::unique_ptr<juce::AudioFormatWriter> createWriter(const RenderOptions& options, const juce::File& file, int numChannels)
+{
+    std::unique_ptr<juce::AudioFormat> format;
+    if (options.format == "flac")
+        format = std::make_unique<juce::FlacAudioFormat>();
+    else
+        format = std::make_unique<juce::WavAudioFormat>();
+
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    if (!stream->openedOk())
+        return {};
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), options.sampleRate,
+        static_cast<unsigned int>(numChannels), options.bitDepth, {}, 0));
+    if (writer != nullptr)
+        stream.release(); // the writer owns it now
+    return writer;
+}
+
+static juce::File getOutputFile(const RenderOptions& options, const juce::File& input)
+{
+    const auto dir = options.outputDir != juce::File() ? options.outputDir : input.getParentDirectory();
+    return dir.getChildFile(input.getFileNameWithoutExtension()).withFileExtension(options.format);
+}
+
+static juce::Result renderFile(const RenderOptions& options, const juce::File& input, const juce::File& output)
+{
+    juce::MidiMessageSequence sequence;
+    auto result = loadMidi(input, sequence);
+    if (result.failed())
+        return result;
+
+    // Jobs render side by side on the pool's threads; each processor renders its voices serially.
+    CyqnusAudioProcessor processor(true);
+    processor.setNonRealtime(true);
+
+    // The preset bank is only needed for Program Changes.
+    for (const auto* event : sequence)
+    {
+        if (event->message.isProgramChange())
+        {
+            processor.loadPresetBank(CyqnusAudioProcessor::getDefaultPresetBankFile());
+            break;
+        }
+    }
+
+    if (options.preset != juce::File() && (result = processor.loadStateFile(options.preset)).failed())
+        return result;
+
+    const int numChannels = processor.getTotalNumOutputChannels();
+    processor.setPlayConfigDetails(0, numChannels, options.sampleRate, options.blockSize);
+    processor.prepareToPlay(options.sampleRate, options.blockSize);
+
+    auto writer = createWriter(options, output, numChannels);
+    if (writer == nullptr)
+        return juce::Result::fail("Could not create " + output.getFullPathName());
+
+    // Oversampling delays the output; render that much longer and drop it from the start.
+    const int latency = processor.getLatencySamples();
+    const double lengthSeconds = sequence.getEndTime() + options.tailSeconds;
+    const auto totalSamples = static_cast<juce::int64>(std::ceil(lengthSeconds * options.sampleRate)) + latency;
+    juce::int64 samplesToSkip = latency;
+
+    juce::AudioBuffer<float> buffer(numChannels, options.blockSize);
+    juce::MidiBuffer midi;
+    int nextEvent = 0;
+
+    for (juce::int64 position = 0; position < totalSamples; position += options.blockSize)
+    {
+        const int numSamples = static_cast<int>(juce::jmin<juce::int64>(options.blockSize, totalSamples - position));
+        const double blockEnd = static_cast<double>(position + numSamples) / options.sampleRate;
+
+        midi.clear();
+        for (; nextEvent < sequence.getNumEvents(); ++nextEvent)
+        {
+            const auto& message = sequence.getEventPointer(nextEvent)->message;
+            if (message.getTimeStamp() >= blockEnd)
+                break;
+            if (message.isMetaEvent())
+                continue;
+
+            const auto offset = juce::roundToInt(message.getTimeStamp() * options.sampleRate) - position;
+            midi.addEvent(message, juce::jlimit(0, numSamples - 1, static_cast<int>(offset)));
+        }
+
+        buffer.setSize(numChannels, numSamples, false, false, true);
+        processor.processBlock(buffer, midi);
+        const int skip = static_cast<int>(juce::jmin<juce::int64>(samplesToSkip, numSamples));
+        samplesToSkip -= skip;
+        if (skip < numSamples)
+            writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip);
+
+        // Every note has run out after the last event, the rest of the tail would be zeros.
+        if (nextEvent >= sequence.getNumEvents() && processor.isOutputSilent())
+            break;
+    }
+
+    processor.releaseResources();
+
+    if (options.writeStats)
+    {
+        auto* stats = new juce::DynamicObject();
+        stats->setProperty("input", input.getFullPathName());
+        stats->setProperty("sampleRate", options.sampleRate);
+        stats->setProperty("blockSize", options.blockSize);
+        stats->setProperty("processBlock", processor.blockLoad.toVar());
+        stats->setProperty("voiceRender", processor.voiceLoad.toVar());
+
+        const auto statsFile = output.withFileExtension("stats.json");
+        if (!statsFile.replaceWithText(juce::JSON::toString(juce::var(stats))))
+            return juce::Result::fail("Could not write " + statsFile.getFullPathName());
+    }
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    RenderOptions options;
+    juce::Array<juce::File> inputs;
+
+    for (const auto& arg : args.arguments)
+        if (!arg.isOption())
+            inputs.add(arg.resolveAsFile());
+
+    if (inputs.isEmpty() || args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return inputs.isEmpty() ? 1 : 0;
+    }
+
+    if (args.containsOption("--make-bank"))
+    {
+        // The inputs are preset states here, one bank entry each in the given order.
+        CyqnusAudioProcessor processor(true);
+        const auto bankFile = args.getFileForOption("--make-bank");
+        const auto result = processor.writePresetBank(bankFile, inputs);
+        if (result.failed())
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+        std::cout << bankFile.getFullPathName() << " (" << inputs.size() << " presets)" << std::endl;
+        return 0;
+    }
+
+    if (args.containsOption("--preset"))  options.preset = args.getFileForOption("--preset");
+    if (args.containsOption("--out-dir")) options.outputDir = args.getFileForOption("--out-dir");
+    if (args.containsOption("--format"))  options.format = args.getValueForOption("--format").toLowerCase();
+    if (args.containsOption("--rate"))    options.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+    if (args.containsOption("--block"))   options.blockSize = args.getValueForOption("--block").getIntValue();
+    if (args.containsOption("--bits"))    options.bitDepth = args.getValueForOption("--bits").getIntValue();
+    if (args.containsOption("--tail"))    options.tailSeconds = args.getValueForOption("--tail").getDoubleValue();
+    if (args.containsOption("--jobs"))    options.numJobs = args.getValueForOption("--jobs").getIntValue();
+    options.writeStats = args.containsOption("--stats");
+
+    if (options.sampleRate <= 0.0 || options.blockSize <= 0 || (options.format != "wav" && options.format != "flac"))
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (options.numJobs <= 0)
+        options.numJobs = juce::SystemStats::getNumCpus();
+    if (options.outputDir != juce::File())
+        options.outputDir.createDirectory();
+
+    // Inputs with the same name from different directories would all write one file in
+    // --out-dir (at the same time with --jobs), so that is refused before anything is rendered.
+    juce::Array<juce::File> outputs;
+    for (const auto& input : inputs)
+    {
+        const auto output = getOutputFile(options, input);
+        const int other = outputs.indexOf(output);
+        if (other >= 0)
+        {
+            std::cerr << inputs[other].getFullPathName() << " and " << input.getFullPathName()
+                      << " would both be rendered to " << output.getFullPathName() << std::endl;
+            return 1;
+        }
+        outputs.add(output);
+    }
+
+    std::atomic<int> numFailed{ 0 };
+    juce::CriticalSection logLock;
+
+    auto renderOne = [&](const juce::File& input)
+    {
+        const auto output = getOutputFile(options, input);
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        const auto result = renderFile(options, input, output);
+
+        const juce::ScopedLock sl(logLock);
+        if (result.failed())
+        {
+            ++numFailed;
+            std::cerr << result.getErrorMessage() << std::endl;
+        }
+        else
+        {
+            std::cout << output.getFullPathName() << " ("
+                      << juce::String((juce::Time::getMillisecondCounterHiRes() - start) / 1000.0, 2) << " s)" << std::endl;
+        }
+    };
+
+    if (options.numJobs == 1 || inputs.size() == 1)
+    {
+        for (const auto& input : inputs)
+            renderOne(input);
+    }
+    else
+    {
+        juce::ThreadPool pool(juce::jmin(options.numJobs, inputs.size()));
+        for (const auto& input : inputs)
+            pool.addJob([&renderOne, input] { renderOne(input); });
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(20);
+    }
+
+    return numFailed.load() == 0 ? 0 : 1;
+}